@@ -1,8 +1,32 @@
 #!/usr/bin/env bash
 echo "Building 'judge/judge'..."
 
-/usr/local/bin/g++-12 -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation judge/all_in_one.cpp -o judge/judge
-#g++ -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation judge/all_in_one.cpp -o judge/judge
+/usr/local/bin/g++-12 -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/playground.cpp -o judge/judge -ldl
+#g++ -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/playground.cpp -o judge/judge -ldl
+echo "Done."
+
+echo "Building 'judge/evaluator'..."
+/usr/local/bin/g++-12 -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/evaluator.cpp -o judge/evaluator -ldl
+#g++ -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/evaluator.cpp -o judge/evaluator -ldl
+echo "Done."
+
+echo "Building 'judge/binlog_to_json'..."
+/usr/local/bin/g++-12 -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/binlog_to_json.cpp -o judge/binlog_to_json -ldl
+#g++ -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/binlog_to_json.cpp -o judge/binlog_to_json -ldl
+echo "Done."
+
+echo "Building 'judge/action_bench'..."
+/usr/local/bin/g++-12 -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/action_bench.cpp -o judge/action_bench -ldl
+#g++ -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/action_bench.cpp -o judge/action_bench -ldl
+echo "Done."
+
+echo "Building 'judge/exact_score_test'..."
+/usr/local/bin/g++-12 -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/exact_score_test.cpp -o judge/exact_score_test -ldl
+#g++ -std=c++17 -O2 -I. -Ilib -Ijudge -Wno-format-truncation -rdynamic -pthread judge/all_in_one.cpp judge/exact_score_test.cpp -o judge/exact_score_test -ldl
+echo "Done."
+
+echo "Building 'judge/stationary_dist_test'..."
+g++ -std=c++17 -O2 -I. -Ilib -Ijudge judge/stationary_dist_test.cpp -o judge/stationary_dist_test
 echo "Done."
 
 echo "Building 'generator/trans_prob_mat_generator'..."
@@ -4,24 +4,13 @@
 #include <vector>
 #include "lib/Eigen/Core"
 #include "lib/cmdline.h"
+#include "stationary_dist.hpp"
 using Mat =
     Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
-Eigen::VectorXd calc_stationary_dist(Mat mat, double eps = 1e-12) {
-    for (int i = 0; i < mat.rows(); i++) {
-        mat.row(i) /= mat.row(i).sum();
-    }
-    for (int i__ = 0; i__ < 64; i__++) {
-        Mat mat2 = mat * mat;
-        for (int i = 0; i < mat.rows(); i++) {
-            mat2.row(i) /= mat2.row(i).sum();
-        }
-        double diff = (mat2 - mat).norm();
-        mat = std::move(mat2);
-        if (diff < mat.rows() * eps) {
-            break;
-        }
-    }
-    return mat.row(0) / mat.row(0).sum();
+Eigen::VectorXd calc_stationary_dist(const Mat& mat) {
+    std::vector<double> sta = stationary_distribution(
+        std::vector<double>(mat.data(), mat.data() + mat.size()), mat.rows());
+    return Eigen::Map<Eigen::VectorXd>(sta.data(), sta.size());
 }
 Mat generate_trans_prob_mat(Eigen::VectorXd stationary_dist, int adj_range,
                             double sharpness, uint64_t seed,
@@ -50,7 +39,7 @@ Mat generate_trans_prob_mat(Eigen::VectorXd stationary_dist, int adj_range,
     double qual_base = n * std::numeric_limits<double>::epsilon();
     Mat mat2;
     for (int r__ = 0; r__ < loop_max; r__++) {
-        auto sta = calc_stationary_dist(mat, eps);
+        auto sta = calc_stationary_dist(mat);
         n1 = (stationary_dist - sta).lpNorm<Eigen::Infinity>();
         double n1_qual = std::log(n1) / std::log(qual_base);
         int n1_qual_d = std::floor(n1_qual * 10);
@@ -94,7 +83,7 @@ Mat generate_trans_prob_mat(Eigen::VectorXd stationary_dist, int adj_range,
                 continue;
             }
         }
-        auto sta2 = calc_stationary_dist(mat2, eps);
+        auto sta2 = calc_stationary_dist(mat2);
         n2 = (stationary_dist - sta2).lpNorm<Eigen::Infinity>();
         if (n1 > n2) {
             mat = mat2;
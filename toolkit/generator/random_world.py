@@ -141,6 +141,11 @@ OPTIONS = [
 大きくすると計算は早いが、定常分布が指定したものと大きくずれた行列が生成される可能性がある。''', '実数', '2.220446049250313e-16 以上 1.0 未満', True, '1e-8'),
     OptionItem('weather_prob_centralize', '天候確率行列を、対角成分が最大になるように制限する',
                '真偽値', 'true or false', False, 'true'),
+    OptionItem('weather_sampling', '''天候遷移のサンプリング方法
+"discrete_distribution": 従来通り(std::discrete_distribution)。既存のテストケースと同じ天候になる
+"alias": エイリアス法による O(1) のサンプリング
+"philox": エイリアス法 + カウンタベースの乱数(Philox)。各ターンの天候を前のターンを再現せずに計算できる''',
+               '文字列', '"discrete_distribution" or "alias" or "philox"', False, '"discrete_distribution"'),
     OptionItem('weather_limit_const', '天候制限定数(d^weatherの冪)',
                '整数の列', '各要素は0以上。要素数は定常分布の要素数と等しい必要がある。', True, '''[[
   0,
@@ -427,7 +432,11 @@ def main():
     weather_stationary_dist = [random_expr_float(f'weather_stationary_dist_{i}',
                                                  e) for i, e in enumerate(c.pick_array('weather_stationary_dist'))]
     ############################################################################
-    print(f'{len(weather_stationary_dist)} {interval} {random.getrandbits(64)}')
+    weather_sampling = c.pick('weather_sampling') if 'weather_sampling' in c.config else 'discrete_distribution'
+    weather_seed_line = f'{len(weather_stationary_dist)} {interval} {random.getrandbits(64)}'
+    if weather_sampling != 'discrete_distribution':
+        weather_seed_line += f' {weather_sampling}'
+    print(weather_seed_line)
     ############################################################################
     sys.stdout.flush()
 
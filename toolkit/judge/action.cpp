@@ -1,85 +1,142 @@
 #include "action.hpp"
-#include <memory>
-#include <regex>
+#include <charconv>
 #include <sstream>
+#include <string_view>
 #include "lib/json.hpp"
-#include "worker.hpp"
-namespace action {
-void to_json(json_ref j, const Action& a) {
-    a.to_json_impl(j);
+static bool is_action_space_(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' ||
+           c == '\r';
 }
-std::ostream& operator<<(std::ostream& os, const Action& a) {
-    json j = a;
-    os << j;
-    return os;
+static std::string_view read_action_token_(std::string_view& s) {
+    size_t b = 0;
+    while (b < s.size() && is_action_space_(s[b])) {
+        b++;
+    }
+    size_t e = b;
+    while (e < s.size() && !is_action_space_(s[e])) {
+        e++;
+    }
+    std::string_view ret = s.substr(b, e - b);
+    s.remove_prefix(e);
+    return ret;
 }
-}
-action::Stay::Stay(std::string s) : Stay() {
+template <class T>
+static bool read_action_int_(std::string_view& s, T& v, bool& overflow) {
 #ifndef ONLINE_JUDGE
-    THROW_WA_IF(WrongAnswerType::INVALID_STAY_STRING,
-                !std::regex_match(s, std::regex(action_regex())),
-                "Regex mismatch for Stay:%s", action_regex().c_str());
+    if (s.size() < 2 || s[0] != ' ' || s[1] < '1' || '9' < s[1]) {
+        return false;
+    }
+    s.remove_prefix(1);
+#else
+    while (!s.empty() && is_action_space_(s.front())) {
+        s.remove_prefix(1);
+    }
+    if (s.size() >= 2 && s[0] == '+' && '0' <= s[1] && s[1] <= '9') {
+        s.remove_prefix(1);
+    }
 #endif
+    auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), v);
+    if (ec == std::errc::invalid_argument) {
+        return false;
+    }
+    overflow |= ec == std::errc::result_out_of_range;
+    s.remove_prefix(ptr - s.data());
+    return true;
 }
-void action::Stay::to_json_impl(json_ref j) const {
-    j = json{{"type", action_type_to_str(type())}};
-}
-void action::Stay::dispatch(discrete_time_t current_time, Worker* w) const {
-    w->do_action(current_time, *this);
-}
-action::Move::Move(std::string s) {
+template <class... T>
+static int read_action_args_(WrongAnswerType type, const char* format,
+                             bool name_at_line_start, std::string_view s,
+                             T&... values) {
+    bool valid = name_at_line_start;
+    bool overflow = false;
+    ((valid = valid && read_action_int_(s, values, overflow)), ...);
 #ifndef ONLINE_JUDGE
-    THROW_WA_IF(WrongAnswerType::INVALID_MOVE_STRING,
-                !std::regex_match(s, std::regex(action_regex())),
-                "Regex mismatch for Move:%s", action_regex().c_str());
+    valid = valid && s.find_first_not_of(' ') == std::string_view::npos;
+    THROW_WA_IF(type, !valid, "Format mismatch (expected:%s)", format);
+#endif
+    THROW_RUNTIME_ERROR_IF(!valid || overflow,
+                           "Failed to read the arguments of an action (%s)",
+                           format);
+#ifndef ONLINE_JUDGE
+    return s.size();
+#else
+    return 0;
 #endif
-    std::stringstream ss;
-    std::string name;
-    ss << s;
-    ValueReader r(ss);
-    r >> TAG(ValueGroup::STRING, name) >> TAG(ValueGroup::INDEX, to);
-}
-void action::Move::dispatch(discrete_time_t current_time, Worker* w) const {
-    w->do_action(current_time, *this);
-}
-void action::Move::to_json_impl(json_ref j) const {
-    j = json{{"type", action_type_to_str(type())}, {"to", to}};
 }
-action::Execute::Execute(std::string s) {
+action::Action action::interpret(std::string_view str,
+                                 int* trailing_space_num) {
+    std::string_view rest = str;
+    std::string_view action_name = read_action_token_(rest);
 #ifndef ONLINE_JUDGE
-    THROW_WA_IF(WrongAnswerType::INVALID_EXECUTE_STRING,
-                !std::regex_match(s, std::regex(action_regex())),
-                "Regex mismatch for Execute:%s", action_regex().c_str());
+    const bool name_at_line_start = action_name.data() == str.data();
+#else
+    const bool name_at_line_start = true;
 #endif
+    int spaces = 0;
+    Action ret;
+    if (action_name == Stay::action_name) {
+        spaces = read_action_args_(WrongAnswerType::INVALID_STAY_STRING,
+                                   "stay *", name_at_line_start, rest);
+    } else if (action_name == Move::action_name) {
+        Move m;
+        spaces = read_action_args_(WrongAnswerType::INVALID_MOVE_STRING,
+                                   "move [1-9][0-9]* *", name_at_line_start,
+                                   rest, m.to);
+        m.to = to_0b(m.to);
+        ret = m;
+    } else if (action_name == Execute::action_name) {
+        Execute e;
+        spaces = read_action_args_(WrongAnswerType::INVALID_EXECUTE_STRING,
+                                   "execute [1-9][0-9]* [1-9][0-9]* *",
+                                   name_at_line_start, rest, e.job_id,
+                                   e.amount);
+        THROW_RUNTIME_ERROR_IF(e.amount <= 0,
+                               "The amount of Execute must be positive (%d)",
+                               e.amount);
+        e.job_id = to_0b(e.job_id);
+        ret = e;
+    } else {
+        THROW_WA_IF(WrongAnswerType::INVALID_ACTION_NAME, true,
+                    "Unknown action name");
+    }
+    if (trailing_space_num) {
+        *trailing_space_num = spaces;
+    }
+    return ret;
+}
+action::ActionType action::type_of(const Action& a) {
+    return std::visit([](const auto& x) { return x.type(); }, a);
+}
+std::string action::to_contestant_string(const Action& a,
+                                         int trailing_space_num) {
     std::stringstream ss;
-    std::string name;
-    ss << s;
-    ValueReader r(ss);
-    r >> TAG(ValueGroup::STRING, name) >> TAG(ValueGroup::INDEX, job_id) >>
-        TAG(ValueGroup::POSITIVE_COUNT, amount);
+    ValueWriter w(ss);
+    if (std::holds_alternative<Stay>(a)) {
+        ss << Stay::action_name;
+    } else if (const auto* m = std::get_if<Move>(&a)) {
+        concat_for_contestant(w, TAG(ValueGroup::STRING, Move::action_name),
+                              TAG(ValueGroup::INDEX, m->to));
+    } else if (const auto* e = std::get_if<Execute>(&a)) {
+        concat_for_contestant(w, TAG(ValueGroup::STRING, Execute::action_name),
+                              TAG(ValueGroup::INDEX, e->job_id),
+                              TAG(ValueGroup::POSITIVE_COUNT, e->amount));
+    }
+    return ss.str() + std::string(trailing_space_num, ' ');
 }
-void action::Execute::dispatch(discrete_time_t current_time, Worker* w) const {
-    w->do_action(current_time, *this);
+std::string action::ActionRecord::to_raw_string() const {
+    return to_contestant_string(action, trailing_space_num);
 }
-void action::Execute::to_json_impl(json_ref j) const {
-    j = json{{"type", action_type_to_str(type())},
-             {"job_id", job_id},
-             {"amount", amount}};
+void action::to_json(json_ref j, const Action& a) {
+    j = json{{"type", action_type_to_str(type_of(a))}};
+    if (const auto* m = std::get_if<Move>(&a)) {
+        j["to"] = m->to;
+    } else if (const auto* e = std::get_if<Execute>(&a)) {
+        j["job_id"] = e->job_id;
+        j["amount"] = e->amount;
+    }
 }
-std::shared_ptr<action::Action> action::Action::interpret(std::string str) {
-    std::stringstream ss;
-    ss << str;
-    std::string action_name;
-    ss >> action_name;
-#define RETURN_ACTION(name) \
-    do { \
-        if (action_name == action::name::action_name) { \
-            return std::make_shared<action::name>(str); \
-        } \
-    } while (0)
-    RETURN_ACTION(Stay);
-    RETURN_ACTION(Move);
-    RETURN_ACTION(Execute);
-    THROW_WA_IF(WrongAnswerType::INVALID_ACTION_NAME, true,
-                "Unknown action name");
+std::ostream& action::operator<<(std::ostream& os, const Action& a) {
+    json j = a;
+    os << j;
+    return os;
 }
@@ -0,0 +1,72 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "action.hpp"
+#include "lib/cmdline.h"
+// Throughput of action::interpret() on mixed stay/move/execute lines, some
+// with trailing spaces, as a solver would print them.
+namespace {
+std::vector<std::string> generate_lines_(int n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int> kind_dist(0, 2);
+    std::uniform_int_distribution<int> vertex_dist(1, 2000);
+    std::uniform_int_distribution<int> job_dist(1, 100000);
+    std::uniform_int_distribution<int> amount_dist(1, 30);
+    std::vector<std::string> ret;
+    ret.reserve(n);
+    for (int i = 0; i < n; i++) {
+        std::string line;
+        switch (kind_dist(rng)) {
+        case 0:
+            line = "stay";
+            break;
+        case 1:
+            line = "move " + std::to_string(vertex_dist(rng));
+            break;
+        default:
+            line = "execute " + std::to_string(job_dist(rng)) + " " +
+                   std::to_string(amount_dist(rng));
+            break;
+        }
+        if (rng() % 8 == 0) {
+            line += std::string(rng() % 3 + 1, ' ');
+        }
+        ret.push_back(std::move(line));
+    }
+    return ret;
+}
+}
+int main(int argc, char** argv) {
+    cmdline::parser p;
+    p.add<int>("lines", 'n', "1回あたりの行数", false, 100000);
+    p.add<int>("repeat", 'r', "繰り返し回数", false, 20);
+    p.add<uint64_t>("seed", 's', "乱数のシード", false, 1);
+    p.parse_check(argc, argv);
+    const int n = p.get<int>("lines");
+    const int repeat = p.get<int>("repeat");
+    const auto lines = generate_lines_(n, p.get<uint64_t>("seed"));
+    int64_t checksum = 0;
+    double best_ns = 0.0;
+    for (int r = 0; r < repeat; r++) {
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& line : lines) {
+            int trailing_space_num = 0;
+            const action::Action a =
+                action::interpret(line, &trailing_space_num);
+            checksum += static_cast<int>(action::type_of(a)) +
+                        trailing_space_num;
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const double ns =
+            std::chrono::duration<double, std::nano>(end - start).count() / n;
+        if (r == 0 || ns < best_ns) {
+            best_ns = ns;
+        }
+    }
+    std::printf("%d lines x %d: best %.1f ns/line (checksum %lld)\n", n,
+                repeat, best_ns, static_cast<long long>(checksum));
+    return 0;
+}
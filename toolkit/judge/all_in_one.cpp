@@ -2,7 +2,6 @@
 #include "action.cpp"
 #include "schedule_manager.cpp"
 #include "graph.cpp"
-#include "playground.cpp"
 #include "worker_manager.cpp"
 #include "job.cpp"
 #include "piecewise_function.cpp"
@@ -11,3 +10,8 @@
 #include "schedule.cpp"
 #include "worker.cpp"
 #include "score.cpp"
+#include "exact_score.cpp"
+#include "binary_log.cpp"
+#include "seekable_log.cpp"
+#include "turn_profiler.cpp"
+#include "solver_process.cpp"
@@ -0,0 +1,557 @@
+#include "binary_log.hpp"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include "error_check.hpp"
+#include "json_log.hpp"
+#include "schedule.hpp"
+BinaryLogQuad to_binary_log_quad(const float_score_t& v) {
+    const auto& b = v.backend();
+    const size_t n = b.bits().size() * sizeof(*b.bits().limbs());
+    THROW_LOGIC_ERROR_IF(n > sizeof(BinaryLogQuad::bits),
+                         "Too many limbs in a score value.");
+    BinaryLogQuad q;
+    q.exponent = b.exponent();
+    q.sign = b.sign();
+    q.bits_size = n;
+    std::memcpy(q.bits, b.bits().limbs(), n);
+    return q;
+}
+float_score_t from_binary_log_quad(const BinaryLogQuad& q) {
+    float_score_t v;
+    auto& b = v.backend();
+    const size_t limb_size = sizeof(*b.bits().limbs());
+    const size_t n = q.bits_size / limb_size;
+    b.exponent() = q.exponent;
+    b.sign() = q.sign;
+    b.bits().resize(n, n);
+    THROW_RUNTIME_ERROR_IF(q.bits_size > sizeof(q.bits) ||
+                               q.bits_size % limb_size != 0 ||
+                               b.bits().size() != n,
+                           "Invalid score value in the binary log.");
+    std::memcpy(b.bits().limbs(), q.bits, q.bits_size);
+    return v;
+}
+BinaryLogWriter::BinaryLogWriter(std::ostream& os) : os_(os) {
+}
+void BinaryLogWriter::begin_session(WorldType wt, discrete_time_t t_max,
+                                    std::string begin_json) {
+    header_.world_type = static_cast<int32_t>(wt);
+    header_.turn_num = t_max;
+    begin_json_ = std::move(begin_json);
+}
+void BinaryLogWriter::add_relevant_job(job_id_t id) {
+    relevant_job_ids_.push_back(id);
+}
+void BinaryLogWriter::begin_turns(int worker_num, int division_num) {
+    header_.worker_num = worker_num;
+    header_.relevant_job_num = relevant_job_ids_.size();
+    header_.division_num = division_num;
+    score_jobwise_index_.assign(1, 0);
+    schedule_update_index_.assign(1, 0);
+}
+void BinaryLogWriter::add_task_cumul(int task_cumul) {
+    task_cumul_.push_back(task_cumul);
+}
+void BinaryLogWriter::add_schedule_penalty(double penalty) {
+    schedule_penalty_.push_back(penalty);
+}
+void BinaryLogWriter::add_schedule_update(worker_id_t wid,
+                                          const Schedule& s) {
+    BinaryLogScheduleUpdate u;
+    u.worker_id = wid;
+    u.update_time = s.update_time();
+    u.t_max = s.T_max();
+    u.is_valid = s.is_valid();
+    u.element_begin = schedule_element_.size();
+    u.element_num = s.size();
+    for (const auto& a : s) {
+        schedule_element_.push_back(a.job_id);
+    }
+    schedule_update_.push_back(u);
+}
+void BinaryLogWriter::add_jobwise_score(job_id_t id, const float_score_t& s) {
+    BinaryLogJobwiseScore e;
+    e.job_id = id;
+    e.score = to_binary_log_quad(s);
+    score_jobwise_.push_back(e);
+}
+void BinaryLogWriter::set_score(const float_score_t& score,
+                                const float_score_t& sum) {
+    score_.push_back(to_binary_log_quad(score));
+    score_jobwise_sum_.push_back(to_binary_log_quad(sum));
+}
+void BinaryLogWriter::add_weather(weather_value_t v) {
+    weather_.push_back(v);
+}
+void BinaryLogWriter::add_worker(const Position& p,
+                                 const action::ActionRecord* last) {
+    BinaryLogPosition bp;
+    bp.distance_from_u = p.distance_from_u;
+    bp.u = p.u;
+    bp.v = p.v;
+    worker_position_.push_back(bp);
+    BinaryLogAction ba;
+    if (last != nullptr) {
+        ba.type = static_cast<int32_t>(action::type_of(last->action));
+        ba.trailing_space_num = last->trailing_space_num;
+        if (const auto* m = std::get_if<action::Move>(&last->action)) {
+            ba.arg0 = m->to;
+        } else if (const auto* e =
+                       std::get_if<action::Execute>(&last->action)) {
+            ba.arg0 = e->job_id;
+            ba.arg1 = e->amount;
+        }
+    }
+    worker_action_.push_back(ba);
+}
+void BinaryLogWriter::end_turn() {
+    turn_num_++;
+    const size_t t = turn_num_;
+    score_jobwise_index_.push_back(score_jobwise_.size());
+    schedule_update_index_.push_back(schedule_update_.size());
+    THROW_LOGIC_ERROR_IF(
+        worker_position_.size() != t * header_.worker_num ||
+            schedule_penalty_.size() != t * header_.worker_num ||
+            task_cumul_.size() != t * header_.relevant_job_num ||
+            weather_.size() != t * (header_.division_num + 1) ||
+            score_.size() != t,
+        "Turn data in the binary log are inconsistent.");
+}
+void BinaryLogWriter::write_padded_(const void* p, size_t n) {
+    static const char zeros[8] = {};
+    os_.write(static_cast<const char*>(p), n);
+    os_.write(zeros, (8 - n % 8) % 8);
+}
+void BinaryLogWriter::end_session(final_result_t score,
+                                  double unfinished_penalty,
+                                  const std::vector<job_id_t>& executed_jobs) {
+    THROW_LOGIC_ERROR_IF(turn_num_ != header_.turn_num,
+                         "The binary log lacks some turns.");
+    header_.final_score = score;
+    header_.unfinished_penalty = unfinished_penalty;
+    executed_jobs_.assign(executed_jobs.begin(), executed_jobs.end());
+    const std::pair<const void*, size_t> sections[BINARY_LOG_SECTION_NUM] = {
+        {begin_json_.data(), begin_json_.size()},
+#define SECTION_(v) {v.data(), v.size() * sizeof(v[0])}
+        SECTION_(relevant_job_ids_),
+        SECTION_(executed_jobs_),
+        SECTION_(worker_position_),
+        SECTION_(worker_action_),
+        SECTION_(task_cumul_),
+        SECTION_(weather_),
+        SECTION_(score_),
+        SECTION_(score_jobwise_sum_),
+        SECTION_(schedule_penalty_),
+        SECTION_(score_jobwise_index_),
+        SECTION_(score_jobwise_),
+        SECTION_(schedule_update_index_),
+        SECTION_(schedule_update_),
+        SECTION_(schedule_element_),
+#undef SECTION_
+    };
+    uint64_t offset = (sizeof(header_) + 7) / 8 * 8;
+    for (int i = 0; i < BINARY_LOG_SECTION_NUM; i++) {
+        header_.section_offset[i] = offset;
+        header_.section_size[i] = sections[i].second;
+        offset += (sections[i].second + 7) / 8 * 8;
+    }
+    write_padded_(&header_, sizeof(header_));
+    for (int i = 0; i < BINARY_LOG_SECTION_NUM; i++) {
+        write_padded_(sections[i].first, sections[i].second);
+    }
+    os_.flush();
+    THROW_RUNTIME_ERROR_IF(!os_, "Failed to write the binary log.");
+}
+BinaryLog::BinaryLog(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    THROW_RUNTIME_ERROR_IF(fd == -1, "Failed to open the file:%s",
+                           path.c_str());
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        map_size_ = st.st_size;
+        map_ = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);
+    if (map_ == MAP_FAILED) {
+        map_ = nullptr;
+    }
+    THROW_RUNTIME_ERROR_IF(map_ == nullptr, "Failed to map the file:%s",
+                           path.c_str());
+    header_ = static_cast<const BinaryLogHeader*>(map_);
+    try {
+        validate_(path);
+    } catch (...) {
+        ::munmap(map_, map_size_);
+        throw;
+    }
+}
+void BinaryLog::validate_(const std::string& path) const {
+    const BinaryLogHeader h;
+    THROW_RUNTIME_ERROR_IF(
+        map_size_ < sizeof(BinaryLogHeader) ||
+            std::memcmp(header_->magic, h.magic, sizeof(h.magic)) != 0,
+        "Not a binary log:%s", path.c_str());
+    THROW_RUNTIME_ERROR_IF(header_->version != BINARY_LOG_VERSION,
+                           "Unsupported binary log version:%u",
+                           header_->version);
+    for (int i = 0; i < BINARY_LOG_SECTION_NUM; i++) {
+        THROW_RUNTIME_ERROR_IF(
+            header_->section_offset[i] % 8 != 0 ||
+                header_->section_offset[i] > map_size_ ||
+                header_->section_size[i] >
+                    map_size_ - header_->section_offset[i],
+            "The binary log is truncated.");
+    }
+    const uint64_t t = header_->turn_num;
+    const uint64_t w = header_->worker_num;
+    const auto size_of = [&](BinaryLogSection s) {
+        return header_->section_size[static_cast<int>(s)];
+    };
+    THROW_RUNTIME_ERROR_IF(
+        header_->turn_num < 0 || header_->worker_num < 0 ||
+            header_->relevant_job_num < 0 || header_->division_num < 0 ||
+            size_of(BinaryLogSection::RELEVANT_JOB_IDS) !=
+                header_->relevant_job_num * sizeof(int32_t) ||
+            size_of(BinaryLogSection::WORKER_POSITION) !=
+                t * w * sizeof(BinaryLogPosition) ||
+            size_of(BinaryLogSection::WORKER_ACTION) !=
+                t * w * sizeof(BinaryLogAction) ||
+            size_of(BinaryLogSection::TASK_CUMUL) !=
+                t * header_->relevant_job_num * sizeof(int32_t) ||
+            size_of(BinaryLogSection::WEATHER) !=
+                t * (header_->division_num + 1) * sizeof(int32_t) ||
+            size_of(BinaryLogSection::SCORE) != t * sizeof(BinaryLogQuad) ||
+            size_of(BinaryLogSection::SCORE_JOBWISE_SUM) !=
+                t * sizeof(BinaryLogQuad) ||
+            size_of(BinaryLogSection::SCHEDULE_PENALTY) !=
+                t * w * sizeof(double) ||
+            size_of(BinaryLogSection::SCORE_JOBWISE_INDEX) !=
+                (t + 1) * sizeof(uint64_t) ||
+            size_of(BinaryLogSection::SCHEDULE_UPDATE_INDEX) !=
+                (t + 1) * sizeof(uint64_t),
+        "Section sizes of the binary log are inconsistent.");
+    const auto check_index = [&](BinaryLogSection index, size_t n) {
+        const auto* idx = section_<uint64_t>(index);
+        for (uint64_t i = 0; i < t; i++) {
+            THROW_RUNTIME_ERROR_IF(idx[i] > idx[i + 1] || idx[i + 1] > n,
+                                   "Broken index in the binary log.");
+        }
+    };
+    check_index(BinaryLogSection::SCORE_JOBWISE_INDEX,
+                section_num_<BinaryLogJobwiseScore>(
+                    BinaryLogSection::SCORE_JOBWISE));
+    check_index(BinaryLogSection::SCHEDULE_UPDATE_INDEX,
+                section_num_<BinaryLogScheduleUpdate>(
+                    BinaryLogSection::SCHEDULE_UPDATE));
+    const size_t element_num =
+        section_num_<int32_t>(BinaryLogSection::SCHEDULE_ELEMENT);
+    const auto* updates =
+        section_<BinaryLogScheduleUpdate>(BinaryLogSection::SCHEDULE_UPDATE);
+    for (size_t i = 0;
+         i < section_num_<BinaryLogScheduleUpdate>(
+                 BinaryLogSection::SCHEDULE_UPDATE);
+         i++) {
+        THROW_RUNTIME_ERROR_IF(
+            updates[i].element_begin > element_num ||
+                updates[i].element_num > element_num - updates[i].element_begin,
+            "Broken schedule in the binary log.");
+    }
+}
+BinaryLog::~BinaryLog() {
+    if (map_ != nullptr) {
+        ::munmap(map_, map_size_);
+    }
+}
+void BinaryLog::check_turn_(discrete_time_t t) const {
+    THROW_RUNTIME_ERROR_IF(t < 0 || t >= turn_num(), "turn is out of range");
+}
+WorldType BinaryLog::world_type() const {
+    return static_cast<WorldType>(header_->world_type);
+}
+discrete_time_t BinaryLog::turn_num() const {
+    return header_->turn_num;
+}
+int BinaryLog::worker_num() const {
+    return header_->worker_num;
+}
+int BinaryLog::relevant_job_num() const {
+    return header_->relevant_job_num;
+}
+int BinaryLog::division_num() const {
+    return header_->division_num;
+}
+final_result_t BinaryLog::final_score() const {
+    return header_->final_score;
+}
+double BinaryLog::unfinished_penalty() const {
+    return header_->unfinished_penalty;
+}
+std::string_view BinaryLog::begin_json() const {
+    return std::string_view(section_<char>(BinaryLogSection::BEGIN_JSON),
+                            section_num_<char>(BinaryLogSection::BEGIN_JSON));
+}
+job_id_t BinaryLog::relevant_job_id(int index) const {
+    THROW_RUNTIME_ERROR_IF(index < 0 || index >= relevant_job_num(),
+                           "job index is out of range");
+    return section_<int32_t>(BinaryLogSection::RELEVANT_JOB_IDS)[index];
+}
+std::vector<job_id_t> BinaryLog::executed_jobs() const {
+    const auto* p = section_<int32_t>(BinaryLogSection::EXECUTED_JOBS);
+    return std::vector<job_id_t>(
+        p, p + section_num_<int32_t>(BinaryLogSection::EXECUTED_JOBS));
+}
+Position BinaryLog::worker_position(discrete_time_t t, worker_id_t wid) const {
+    check_turn_(t);
+    THROW_RUNTIME_ERROR_IF(wid < 0 || wid >= worker_num(),
+                           "worker id is out of range");
+    const auto& bp = section_<BinaryLogPosition>(
+        BinaryLogSection::WORKER_POSITION)[t * worker_num() + wid];
+    Position p;
+    p.u = bp.u;
+    p.v = bp.v;
+    p.distance_from_u = bp.distance_from_u;
+    return p;
+}
+bool BinaryLog::has_last_action(discrete_time_t t, worker_id_t wid) const {
+    check_turn_(t);
+    THROW_RUNTIME_ERROR_IF(wid < 0 || wid >= worker_num(),
+                           "worker id is out of range");
+    return section_<BinaryLogAction>(
+               BinaryLogSection::WORKER_ACTION)[t * worker_num() + wid]
+               .type != static_cast<int32_t>(action::ActionType::INVALID);
+}
+action::ActionRecord BinaryLog::last_action(discrete_time_t t,
+                                            worker_id_t wid) const {
+    THROW_RUNTIME_ERROR_IF(!has_last_action(t, wid),
+                           "No action is recorded for worker %d at turn %d",
+                           wid, t);
+    const auto& ba = section_<BinaryLogAction>(
+        BinaryLogSection::WORKER_ACTION)[t * worker_num() + wid];
+    action::ActionRecord r;
+    r.trailing_space_num = ba.trailing_space_num;
+    switch (static_cast<action::ActionType>(ba.type)) {
+        case action::ActionType::STAY:
+            r.action = action::Stay{};
+            break;
+        case action::ActionType::MOVE:
+            r.action = action::Move{ba.arg0};
+            break;
+        case action::ActionType::EXECUTE:
+            r.action = action::Execute{ba.arg0, ba.arg1};
+            break;
+        default:
+            THROW_RUNTIME_ERROR_IF(true, "Invalid action type in the binary "
+                                         "log:%d",
+                                   ba.type);
+    }
+    return r;
+}
+int BinaryLog::task_cumul(discrete_time_t t, int job_index) const {
+    check_turn_(t);
+    THROW_RUNTIME_ERROR_IF(job_index < 0 || job_index >= relevant_job_num(),
+                           "job index is out of range");
+    return section_<int32_t>(
+        BinaryLogSection::TASK_CUMUL)[t * relevant_job_num() + job_index];
+}
+int BinaryLog::task_done(discrete_time_t t, int job_index) const {
+    return task_cumul(t, job_index) -
+           (t == 0 ? 0 : task_cumul(t - 1, job_index));
+}
+weather_value_t BinaryLog::division_weather(discrete_time_t t,
+                                            int division) const {
+    check_turn_(t);
+    THROW_RUNTIME_ERROR_IF(division < 0 || division >= division_num(),
+                           "division is out of range");
+    return section_<int32_t>(
+        BinaryLogSection::WEATHER)[t * (division_num() + 1) + division];
+}
+weather_value_t BinaryLog::time_local_weather(discrete_time_t t) const {
+    check_turn_(t);
+    return section_<int32_t>(
+        BinaryLogSection::WEATHER)[t * (division_num() + 1) + division_num()];
+}
+float_score_t BinaryLog::score(discrete_time_t t) const {
+    check_turn_(t);
+    return from_binary_log_quad(
+        section_<BinaryLogQuad>(BinaryLogSection::SCORE)[t]);
+}
+float_score_t BinaryLog::score_jobwise_sum(discrete_time_t t) const {
+    check_turn_(t);
+    return from_binary_log_quad(
+        section_<BinaryLogQuad>(BinaryLogSection::SCORE_JOBWISE_SUM)[t]);
+}
+std::vector<std::pair<job_id_t, float_score_t>>
+BinaryLog::score_jobwise(discrete_time_t t) const {
+    check_turn_(t);
+    const auto* idx =
+        section_<uint64_t>(BinaryLogSection::SCORE_JOBWISE_INDEX);
+    const auto* e =
+        section_<BinaryLogJobwiseScore>(BinaryLogSection::SCORE_JOBWISE);
+    std::vector<std::pair<job_id_t, float_score_t>> ret;
+    for (uint64_t i = idx[t]; i < idx[t + 1]; i++) {
+        ret.emplace_back(e[i].job_id, from_binary_log_quad(e[i].score));
+    }
+    return ret;
+}
+double BinaryLog::schedule_penalty(discrete_time_t t, worker_id_t wid) const {
+    check_turn_(t);
+    THROW_RUNTIME_ERROR_IF(wid < 0 || wid >= worker_num(),
+                           "worker id is out of range");
+    return section_<double>(
+        BinaryLogSection::SCHEDULE_PENALTY)[t * worker_num() + wid];
+}
+std::vector<BinaryLogSchedule>
+BinaryLog::updated_schedules(discrete_time_t t) const {
+    check_turn_(t);
+    const auto* idx =
+        section_<uint64_t>(BinaryLogSection::SCHEDULE_UPDATE_INDEX);
+    const auto* u =
+        section_<BinaryLogScheduleUpdate>(BinaryLogSection::SCHEDULE_UPDATE);
+    const auto* elems = section_<int32_t>(BinaryLogSection::SCHEDULE_ELEMENT);
+    std::vector<BinaryLogSchedule> ret;
+    for (uint64_t i = idx[t]; i < idx[t + 1]; i++) {
+        ret.push_back({u[i].worker_id, u[i].update_time, u[i].t_max,
+                       u[i].is_valid != 0, elems + u[i].element_begin,
+                       u[i].element_num});
+    }
+    return ret;
+}
+void BinaryLog::write_json(std::ostream& os) const {
+    auto prec_backup = os.precision(std::numeric_limits<double>::max_digits10);
+    os << R"({"world_type":")" << (world_type() == WorldType::A ? "A" : "B")
+       << R"(","begin":)" << begin_json() << "," << std::endl;
+    os << R"("turn_log":[)";
+    for (discrete_time_t t = 0; t < turn_num(); t++) {
+        JsonLogWriter w(os);
+        w.begin_object();
+        w.key("job_manager");
+        w.begin_object();
+        w.key("relevant_jobs");
+        w.begin_array();
+        for (int j = 0; j < relevant_job_num(); j++) {
+            w.begin_object();
+            w.key("id");
+            w.value(relevant_job_id(j));
+            w.key("state");
+            w.begin_object();
+            w.key("pending_task_done");
+            w.value(0);
+            w.key("task_cumul");
+            w.value(task_cumul(t, j));
+            w.end_object();
+            w.end_object();
+        }
+        w.end_array();
+        w.end_object();
+        w.key("schedule_manager");
+        w.begin_object();
+        w.key("schedule_penalties");
+        w.begin_array();
+        for (worker_id_t wid = 0; wid < worker_num(); wid++) {
+            w.pair(wid, schedule_penalty(t, wid));
+        }
+        w.end_array();
+        w.key("updated_schedules");
+        w.begin_array();
+        for (const auto& s : updated_schedules(t)) {
+            w.begin_array();
+            w.value(s.worker_id);
+            w.begin_object();
+            w.key("elements");
+            w.begin_array();
+            for (size_t i = 0; i < s.size; i++) {
+                w.begin_object();
+                w.key("job_id");
+                w.value(s.job_ids[i]);
+                w.end_object();
+            }
+            w.end_array();
+            w.key("is_valid");
+            w.value(s.is_valid);
+            w.key("t_max");
+            w.value(s.t_max);
+            w.key("update_time");
+            w.value(s.update_time);
+            w.end_object();
+            w.end_array();
+        }
+        w.end_array();
+        w.end_object();
+        w.key("score_manager");
+        w.begin_object();
+        w.key("score");
+        w.value(score(t).str());
+        w.key("score_jobwise");
+        w.begin_array();
+        for (const auto& kv : score_jobwise(t)) {
+            w.pair(kv.first, kv.second.str());
+        }
+        w.end_array();
+        w.key("score_jobwise_sum");
+        w.value(score_jobwise_sum(t).str());
+        w.end_object();
+        w.key("weather_manager");
+        w.begin_object();
+        w.key("division_weathers");
+        w.begin_array();
+        for (int d = 0; d < division_num(); d++) {
+            w.value(division_weather(t, d));
+        }
+        w.end_array();
+        w.key("time_local_weather");
+        w.value(time_local_weather(t));
+        w.end_object();
+        w.key("worker_manager");
+        w.begin_object();
+        w.key("workers");
+        w.begin_array();
+        for (worker_id_t wid = 0; wid < worker_num(); wid++) {
+            const Position p = worker_position(t, wid);
+            w.begin_array();
+            w.value(wid);
+            w.begin_object();
+            w.key("id");
+            w.value(wid);
+            w.key("last_action");
+            w.value(has_last_action(t, wid) ? last_action(t, wid).to_raw_string()
+                                            : std::string());
+            w.key("state");
+            w.begin_object();
+            w.key("current_position");
+            w.begin_object();
+            w.key("distance_from_u");
+            w.value(p.distance_from_u);
+            w.key("u");
+            w.value(p.u);
+            w.key("v");
+            w.value(p.v);
+            w.end_object();
+            w.end_object();
+            w.end_object();
+            w.end_array();
+        }
+        w.end_array();
+        w.end_object();
+        w.end_object();
+        if (t < turn_num() - 1) {
+            os << ",";
+        }
+        os << std::endl;
+    }
+    os << "],";
+    os << "\"score\":" << std::to_string(final_score())
+       << ",\"unfinished_penalty\":" << unfinished_penalty()
+       << ",\"executed_jobs\":[";
+    const auto executed = executed_jobs();
+    for (size_t i = 0; i < executed.size(); i++) {
+        os << (i == 0 ? "" : ",") << executed[i];
+    }
+    os << "]" << std::endl;
+    os << "}";
+    os.precision(prec_backup);
+}
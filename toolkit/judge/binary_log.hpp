@@ -0,0 +1,170 @@
+#ifndef HEADER_2HC2022_BINARY_LOG
+#define HEADER_2HC2022_BINARY_LOG 
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "action.hpp"
+#include "defines.hpp"
+#include "graph.hpp"
+#include "weather.hpp"
+class Schedule;
+struct BinaryLogQuad {
+    int32_t exponent = 0;
+    uint8_t sign = 0;
+    uint8_t bits_size = 0;
+    uint16_t padding_ = 0;
+    uint64_t bits[2] = {};
+};
+struct BinaryLogPosition {
+    int64_t distance_from_u = 0;
+    int32_t u = 0;
+    int32_t v = 0;
+};
+struct BinaryLogAction {
+    int32_t type = static_cast<int32_t>(action::ActionType::INVALID);
+    int32_t trailing_space_num = 0;
+    int32_t arg0 = 0;
+    int32_t arg1 = 0;
+};
+struct BinaryLogJobwiseScore {
+    int32_t job_id = INVALID_JOB_ID;
+    int32_t padding_ = 0;
+    BinaryLogQuad score;
+};
+struct BinaryLogScheduleUpdate {
+    int32_t worker_id = INVALID_WORKER_ID;
+    int32_t update_time = INVALID_TIME;
+    int32_t t_max = INVALID_TIME;
+    int32_t is_valid = 0;
+    uint64_t element_begin = 0;
+    uint64_t element_num = 0;
+};
+enum class BinaryLogSection : int {
+    BEGIN_JSON,
+    RELEVANT_JOB_IDS,
+    EXECUTED_JOBS,
+    WORKER_POSITION,
+    WORKER_ACTION,
+    TASK_CUMUL,
+    WEATHER,
+    SCORE,
+    SCORE_JOBWISE_SUM,
+    SCHEDULE_PENALTY,
+    SCORE_JOBWISE_INDEX,
+    SCORE_JOBWISE,
+    SCHEDULE_UPDATE_INDEX,
+    SCHEDULE_UPDATE,
+    SCHEDULE_ELEMENT,
+    NUM
+};
+constexpr int BINARY_LOG_SECTION_NUM = static_cast<int>(BinaryLogSection::NUM);
+constexpr uint32_t BINARY_LOG_VERSION = 1;
+struct BinaryLogHeader {
+    char magic[8] = {'H', 'C', '2', '2', 'B', 'L', 'O', 'G'};
+    uint32_t version = BINARY_LOG_VERSION;
+    int32_t world_type = 0;
+    int32_t turn_num = 0;
+    int32_t worker_num = 0;
+    int32_t relevant_job_num = 0;
+    int32_t division_num = 0;
+    int64_t final_score = 0;
+    double unfinished_penalty = 1.0;
+    uint64_t section_offset[BINARY_LOG_SECTION_NUM] = {};
+    uint64_t section_size[BINARY_LOG_SECTION_NUM] = {};
+};
+BinaryLogQuad to_binary_log_quad(const float_score_t& v);
+float_score_t from_binary_log_quad(const BinaryLogQuad& q);
+class BinaryLogWriter {
+    std::ostream& os_;
+    BinaryLogHeader header_;
+    std::string begin_json_;
+    std::vector<int32_t> relevant_job_ids_;
+    std::vector<int32_t> executed_jobs_;
+    std::vector<BinaryLogPosition> worker_position_;
+    std::vector<BinaryLogAction> worker_action_;
+    std::vector<int32_t> task_cumul_;
+    std::vector<int32_t> weather_;
+    std::vector<BinaryLogQuad> score_;
+    std::vector<BinaryLogQuad> score_jobwise_sum_;
+    std::vector<double> schedule_penalty_;
+    std::vector<uint64_t> score_jobwise_index_;
+    std::vector<BinaryLogJobwiseScore> score_jobwise_;
+    std::vector<uint64_t> schedule_update_index_;
+    std::vector<BinaryLogScheduleUpdate> schedule_update_;
+    std::vector<int32_t> schedule_element_;
+    int turn_num_ = 0;
+    void write_padded_(const void* p, size_t n);
+ public:
+    explicit BinaryLogWriter(std::ostream& os);
+    void begin_session(WorldType wt, discrete_time_t t_max,
+                       std::string begin_json);
+    void add_relevant_job(job_id_t id);
+    void begin_turns(int worker_num, int division_num);
+    void add_task_cumul(int task_cumul);
+    void add_schedule_penalty(double penalty);
+    void add_schedule_update(worker_id_t wid, const Schedule& s);
+    void add_jobwise_score(job_id_t id, const float_score_t& s);
+    void set_score(const float_score_t& score, const float_score_t& sum);
+    void add_weather(weather_value_t v);
+    void add_worker(const Position& p, const action::ActionRecord* last);
+    void end_turn();
+    void end_session(final_result_t score, double unfinished_penalty,
+                     const std::vector<job_id_t>& executed_jobs);
+};
+struct BinaryLogSchedule {
+    worker_id_t worker_id;
+    discrete_time_t update_time;
+    discrete_time_t t_max;
+    bool is_valid;
+    const int32_t* job_ids;
+    size_t size;
+};
+class BinaryLog {
+    void* map_ = nullptr;
+    size_t map_size_ = 0;
+    const BinaryLogHeader* header_ = nullptr;
+    template <class T> const T* section_(BinaryLogSection s) const {
+        return reinterpret_cast<const T*>(
+            static_cast<const char*>(map_) +
+            header_->section_offset[static_cast<int>(s)]);
+    }
+    template <class T> size_t section_num_(BinaryLogSection s) const {
+        return header_->section_size[static_cast<int>(s)] / sizeof(T);
+    }
+    void validate_(const std::string& path) const;
+    void check_turn_(discrete_time_t t) const;
+ public:
+    explicit BinaryLog(const std::string& path);
+    BinaryLog(const BinaryLog&) = delete;
+    BinaryLog& operator=(const BinaryLog&) = delete;
+    ~BinaryLog();
+    WorldType world_type() const;
+    discrete_time_t turn_num() const;
+    int worker_num() const;
+    int relevant_job_num() const;
+    int division_num() const;
+    final_result_t final_score() const;
+    double unfinished_penalty() const;
+    std::string_view begin_json() const;
+    job_id_t relevant_job_id(int index) const;
+    std::vector<job_id_t> executed_jobs() const;
+    Position worker_position(discrete_time_t t, worker_id_t wid) const;
+    bool has_last_action(discrete_time_t t, worker_id_t wid) const;
+    action::ActionRecord last_action(discrete_time_t t,
+                                     worker_id_t wid) const;
+    int task_cumul(discrete_time_t t, int job_index) const;
+    int task_done(discrete_time_t t, int job_index) const;
+    weather_value_t division_weather(discrete_time_t t, int division) const;
+    weather_value_t time_local_weather(discrete_time_t t) const;
+    float_score_t score(discrete_time_t t) const;
+    float_score_t score_jobwise_sum(discrete_time_t t) const;
+    std::vector<std::pair<job_id_t, float_score_t>>
+    score_jobwise(discrete_time_t t) const;
+    double schedule_penalty(discrete_time_t t, worker_id_t wid) const;
+    std::vector<BinaryLogSchedule> updated_schedules(discrete_time_t t) const;
+    void write_json(std::ostream& os) const;
+};
+#endif
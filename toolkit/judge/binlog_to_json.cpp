@@ -0,0 +1,24 @@
+#include <fstream>
+#include <iostream>
+#include "binary_log.hpp"
+#include "lib/cmdline.h"
+int main(int argc, char** argv) {
+    cmdline::parser p;
+    p.footer("<binary_log_file> <OPTIONAL:json_log_output_file>");
+    p.parse_check(argc, argv);
+    if (p.rest().empty() || p.rest().size() > 2) {
+        std::cerr << p.usage();
+        exit(1);
+    }
+    BinaryLog log(p.rest()[0]);
+    if (p.rest().size() == 2) {
+        std::ofstream ofs(p.rest()[1]);
+        if (!ofs) {
+            throw std::runtime_error("Failed to open the file:" +
+                                     p.rest()[1]);
+        }
+        log.write_json(ofs);
+    } else {
+        log.write_json(std::cout);
+    }
+}
@@ -83,49 +83,72 @@ template <class... Args> std::string format_str(Args&&... args) {
                   std::forward<Args>(args)...);
 #pragma GCC diagnostic pop
 #pragma GCC diagnostic pop
-    return std::string(buf.begin(), buf.end());
+    return std::string(buf.data(), len);
 }
-#define BASENAME_ (std::filesystem::path{__FILE__}.filename().c_str())
-#define BASENAME_LINE_STR_ \
-    (format_str("[%s:%d (%s)]", BASENAME_, __LINE__, __func__))
-#define BASENAME_LINE_C_STR_ (BASENAME_LINE_STR_.c_str())
+struct SourceLocation {
+    const char* file = nullptr;
+    int line = 0;
+    const char* func = nullptr;
+    std::string str() const {
+        if (file == nullptr) {
+            return "";
+        }
+        return format_str("[%s:%d (%s)]",
+                          std::filesystem::path{file}.filename().c_str(), line,
+                          func);
+    }
+};
+#define SOURCE_LOCATION_ (SourceLocation{__FILE__, __LINE__, __func__})
+#define BASENAME_LINE_STR_ (SOURCE_LOCATION_.str())
 static constexpr final_result_t WA_SCORE_BASE = -100000000;
+#define WRONG_ANSWER_TYPES_ \
+    def(INVALID) \
+    def(UNKNOWN_ERROR) \
+    def(OUTPUT_ERROR) \
+    def(GENERIC_WA) \
+    def(NEGATIVE_WORKER_NUM_FOR_SCHEDULES) \
+    def(TOO_LARGE_WORKER_NUM_FOR_SCHEDULES) \
+    def(N_CHANGE_NEQ_ACTUAL_WORKER_ID_NUM) \
+    def(WORKER_DOES_NOT_EXIST_FOR_SCHEDULE) \
+    def(DUPS_IN_SCHEDULE_WORKERS) \
+    def(SCHEDULE_JOB_NUM_MISMATCH) \
+    def(INVALID_ACTION_NAME) \
+    def(MOVE_VERTEX_DOES_NOT_EXIST) \
+    def(DO_NOT_SPECIFY_NONSENSE_MOVE_ACTION) \
+    def(FORCE_SCHEDULE_AT_TURN_1_NUM_WORKER) \
+    def(FORCE_SCHEDULE_AT_TURN_1_ID_WORKER) \
+    def(INVALID_MOVE_DESTINATION) \
+    def(INVALID_STAY_STRING) \
+    def(INVALID_MOVE_STRING) \
+    def(INVALID_EXECUTE_STRING) \
+    def(EXECUTE_JOB_ID_DOES_NOT_EXIST) \
+    def(EXECUTE_JOB_ID_IS_NOT_SELECTED) \
+    def(INVALID_EXECUTE_AMOUNT) \
+    def(NO_JOB_EXISTS_AT_CURRENT_POS) \
+    def(WORKER_CANNOT_PROCESS_THIS_TYPE) \
+    def(NONPOSITIVE_REWARD_VALUE) \
+    def(EXCEEDS_TASK_EXECUTION_LIMIT) \
+    def(EXCEEDS_TASK_AMOUNT_REST) \
+    def(DEPENDENCIES_NOT_DONE) \
+    def(SELECTED_NUM_IS_NEGATIVE) \
+    def(SELECTED_NUM_NEQ_ACTUAL_SELECTED_ID_NUM) \
+    def(DUPS_IN_SELECTED_JOBS) \
+    def(SELECTED_JOB_DOES_NOT_EXIST) \
+    def(MUST_SELECT_ALL_MANDATORY_JOBS) \
+    def(MUST_SELECT_ALL_DEPENDENCIES) \
+    def(TIME_LIMIT_EXCEEDED) \
+    def(ACTION_NUM_NEQ_WORKER_NUM)
 enum class WrongAnswerType : final_result_t {
-    INVALID = 0,
-    UNKNOWN_ERROR = 1,
-    OUTPUT_ERROR = 2,
-    GENERIC_WA,
-    NEGATIVE_WORKER_NUM_FOR_SCHEDULES,
-    TOO_LARGE_WORKER_NUM_FOR_SCHEDULES,
-    N_CHANGE_NEQ_ACTUAL_WORKER_ID_NUM,
-    WORKER_DOES_NOT_EXIST_FOR_SCHEDULE,
-    DUPS_IN_SCHEDULE_WORKERS,
-    SCHEDULE_JOB_NUM_MISMATCH,
-    INVALID_ACTION_NAME,
-    MOVE_VERTEX_DOES_NOT_EXIST,
-    DO_NOT_SPECIFY_NONSENSE_MOVE_ACTION,
-    FORCE_SCHEDULE_AT_TURN_1_NUM_WORKER,
-    FORCE_SCHEDULE_AT_TURN_1_ID_WORKER,
-    INVALID_MOVE_DESTINATION,
-    INVALID_STAY_STRING,
-    INVALID_MOVE_STRING,
-    INVALID_EXECUTE_STRING,
-    EXECUTE_JOB_ID_DOES_NOT_EXIST,
-    EXECUTE_JOB_ID_IS_NOT_SELECTED,
-    INVALID_EXECUTE_AMOUNT,
-    NO_JOB_EXISTS_AT_CURRENT_POS,
-    WORKER_CANNOT_PROCESS_THIS_TYPE,
-    NONPOSITIVE_REWARD_VALUE,
-    EXCEEDS_TASK_EXECUTION_LIMIT,
-    EXCEEDS_TASK_AMOUNT_REST,
-    DEPENDENCIES_NOT_DONE,
-    SELECTED_NUM_IS_NEGATIVE,
-    SELECTED_NUM_NEQ_ACTUAL_SELECTED_ID_NUM,
-    DUPS_IN_SELECTED_JOBS,
-    SELECTED_JOB_DOES_NOT_EXIST,
-    MUST_SELECT_ALL_MANDATORY_JOBS,
-    MUST_SELECT_ALL_DEPENDENCIES,
+#define def(x) x,
+    WRONG_ANSWER_TYPES_
+#undef def
 };
+inline std::string wa_type_to_str(WrongAnswerType type) {
+#define def(x) #x,
+    static constexpr const char* names[] = {WRONG_ANSWER_TYPES_};
+#undef def
+    return names[static_cast<std::underlying_type_t<WrongAnswerType>>(type)];
+}
 inline final_result_t wa_type_to_result(WrongAnswerType wa_type) {
     return WA_SCORE_BASE - static_cast<final_result_t>(wa_type);
 }
@@ -0,0 +1,133 @@
+#ifndef HEADER_2HC2022_DISTANCE_MATRIX
+#define HEADER_2HC2022_DISTANCE_MATRIX 
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "defines.hpp"
+// Symmetric all-pairs distance matrix whose cells are only as wide as the
+// largest finite distance needs (uint16, uint32 or int64). In the unsigned
+// widths the all-ones cell marks an unreachable pair. Building with
+// -DTRIANGULAR_DISTANCE_MATRIX stores only the cells with u <= v.
+class DistanceMatrix {
+ public:
+    enum class Width { U16, U32, I64 };
+#ifdef TRIANGULAR_DISTANCE_MATRIX
+    static constexpr bool TRIANGULAR = true;
+#else
+    static constexpr bool TRIANGULAR = false;
+#endif
+    static constexpr distance_t UNREACHABLE = MAX_DISTANCE + 1;
+ private:
+    int n_ = 0;
+    Width width_ = Width::I64;
+    std::vector<uint16_t> u16_;
+    std::vector<uint32_t> u32_;
+    std::vector<int64_t> i64_;
+    size_t index_(vertex_index_t u, vertex_index_t v) const {
+        if constexpr (TRIANGULAR) {
+            if (u > v) {
+                std::swap(u, v);
+            }
+            return static_cast<size_t>(v) * (v + 1) / 2 + u;
+        } else {
+            return static_cast<size_t>(u) * n_ + v;
+        }
+    }
+    template <class T> static distance_t decode_(T c) {
+        if constexpr (std::is_same_v<T, int64_t>) {
+            return c;
+        } else {
+            return c == std::numeric_limits<T>::max() ? UNREACHABLE : c;
+        }
+    }
+    template <class T> static T encode_(distance_t d) {
+        if constexpr (std::is_same_v<T, int64_t>) {
+            return d;
+        } else {
+            return d == UNREACHABLE ? std::numeric_limits<T>::max()
+                                    : static_cast<T>(d);
+        }
+    }
+    template <class T>
+    void read_row_(const std::vector<T>& cells, vertex_index_t u,
+                   distance_t* out) const {
+        if constexpr (TRIANGULAR) {
+            for (int v = 0; v < n_; v++) {
+                out[v] = decode_(cells[index_(u, v)]);
+            }
+        } else {
+            const T* row = &cells[index_(u, 0)];
+            for (int v = 0; v < n_; v++) {
+                out[v] = decode_(row[v]);
+            }
+        }
+    }
+ public:
+    // Every cell starts unreachable. max_finite bounds the distances that
+    // will be stored.
+    void reset(int n, distance_t max_finite) {
+        n_ = n;
+        const size_t cells = TRIANGULAR ? static_cast<size_t>(n) * (n + 1) / 2
+                                        : static_cast<size_t>(n) * n;
+        u16_.clear();
+        u32_.clear();
+        i64_.clear();
+        if (max_finite < std::numeric_limits<uint16_t>::max()) {
+            width_ = Width::U16;
+            u16_.assign(cells, std::numeric_limits<uint16_t>::max());
+        } else if (max_finite < std::numeric_limits<uint32_t>::max()) {
+            width_ = Width::U32;
+            u32_.assign(cells, std::numeric_limits<uint32_t>::max());
+        } else {
+            width_ = Width::I64;
+            i64_.assign(cells, UNREACHABLE);
+        }
+    }
+    Width width() const {
+        return width_;
+    }
+    size_t byte_size() const {
+        return u16_.size() * sizeof(uint16_t) +
+               u32_.size() * sizeof(uint32_t) + i64_.size() * sizeof(int64_t);
+    }
+    distance_t get(vertex_index_t u, vertex_index_t v) const {
+        switch (width_) {
+        case Width::U16:
+            return decode_(u16_[index_(u, v)]);
+        case Width::U32:
+            return decode_(u32_[index_(u, v)]);
+        default:
+            return decode_(i64_[index_(u, v)]);
+        }
+    }
+    void set(vertex_index_t u, vertex_index_t v, distance_t d) {
+        switch (width_) {
+        case Width::U16:
+            u16_[index_(u, v)] = encode_<uint16_t>(d);
+            break;
+        case Width::U32:
+            u32_[index_(u, v)] = encode_<uint32_t>(d);
+            break;
+        default:
+            i64_[index_(u, v)] = encode_<int64_t>(d);
+            break;
+        }
+    }
+    // out[v] = get(u, v) for every v.
+    void read_row(vertex_index_t u, distance_t* out) const {
+        switch (width_) {
+        case Width::U16:
+            read_row_(u16_, u, out);
+            break;
+        case Width::U32:
+            read_row_(u32_, u, out);
+            break;
+        default:
+            read_row_(i64_, u, out);
+            break;
+        }
+    }
+};
+#endif
@@ -70,14 +70,116 @@ class OutputError : public std::runtime_error {
             THROW_WA_IF(type, __VA_ARGS__); \
         } \
     } while (0)
-#define VALIDITY_CHECK_WITH_MSG(invalid_cond,v,m,...) \
+#ifdef TRUSTED_INVARIANTS
+#define THROW_INVARIANT_ERROR_IF(...) \
+    do { \
+    } while (0)
+#else
+#define THROW_INVARIANT_ERROR_IF(...) THROW_LOGIC_ERROR_IF(__VA_ARGS__)
+#endif
+#define CHECK_CODES_ \
+    def(OK, "") \
+    def(POSITION_U_IS_INVALID, "u is INVALID") \
+    def(POSITION_U_IS_NEGATIVE, "u is negative") \
+    def(POSITION_V_IS_INVALID, "v is INVALID") \
+    def(POSITION_V_IS_NEGATIVE, "v is negative") \
+    def(POSITION_DISTANCE_IS_INVALID, "distance is INVALID") \
+    def(POSITION_DISTANCE_IS_NEGATIVE, "distance is negative") \
+    def(POSITION_EXACT_VERTEX_HAS_DISTANCE, \
+        "u == v but the distance is positive (>0)") \
+    def(POSITION_IS_NOT_CANONICAL, \
+        "u != v but the distance is zero (for canonical expression)") \
+    def(POSITION_U_IS_OUT_OF_RANGE, "u is out of range (too large)") \
+    def(POSITION_V_IS_OUT_OF_RANGE, "v is out of range (too large)") \
+    def(POSITION_IS_NOT_CONNECTED, "p.u and p.v is not connected.") \
+    def(POSITION_DISTANCE_IS_TOO_LARGE, "The distance is too large") \
+    def(POSITION_IS_NOT_ON_EDGE, "Exact vertex but p.u != p.v") \
+    def(WORKER_HAS_NO_PROCESSABLE_TYPE, \
+        "This worker has no processable types.") \
+    def(WORKER_PROCESSABLE_TYPE_IS_INVALID, \
+        "Processable type is invalid or out of range.") \
+    def(WORKER_INITIAL_POSITION_IS_INVALID, \
+        "This worker's initial position is invalid.") \
+    def(WORKER_MAX_TASK_IS_NOT_POSITIVE, \
+        "This worker has 0 or negative max task process amount") \
+    def(WORKER_GRAPH_IS_NOT_SET, "Graph is not set.") \
+    def(WORKER_MANAGER_IS_NOT_SET, "WorkerManager is not set.") \
+    def(WORKER_ID_IS_INVALID, "Worker id is invalid.") \
+    def(WORKER_MANAGER_JOB_MANAGER_IS_NOT_SET, "JobManager is not set.") \
+    def(WORKER_MANAGER_GRAPH_IS_NOT_SET, "Graph is not set.") \
+    def(WORKER_MANAGER_HAS_NO_WORKER, "No worker exists.") \
+    def(JOB_TYPE_IS_INVALID, "Job type is INVALID or negative(internal)") \
+    def(JOB_TASK_NUM_IS_INVALID, "Task num is INVALID") \
+    def(JOB_TASK_NUM_IS_NOT_POSITIVE, "Task num is 0 or negative") \
+    def(JOB_HAS_NO_GAIN_FUNCTION, "No gain function data.") \
+    def(JOB_POSITION_IS_INVALID, "Position index is INVALID") \
+    def(JOB_POSITION_IS_NEGATIVE, "Position index is negative") \
+    def(JOB_PENALTY_COEFF_IS_INVALID, "Penalty coefficient is INVALID") \
+    def(JOB_PENALTY_COEFF_IS_OUT_OF_RANGE, \
+        "Penalty coefficient is out of range") \
+    def(JOB_TASK_CUMUL_IS_INVALID, \
+        "Cumulative task amount is invalid (including negative)") \
+    def(JOB_PENDING_TASK_IS_NEGATIVE, \
+        "Temporary cumulative task amount(to be recorded at the next " \
+        "finalization) is negative") \
+    def(JOB_ID_IS_INVALID, "Job ID is invalid.") \
+    def(JOB_ID_IS_NEGATIVE, "Job ID is negative.") \
+    def(JOB_MANAGER_WORLD_TYPE_IS_INVALID, "World type is invalid.") \
+    def(JOB_MANAGER_WEATHER_MANAGER_IS_NOT_SET, "WeatherManager is not set.") \
+    def(JOB_MANAGER_TASK_LIMIT_INFO_IS_NOT_SET, "TaskLimitInfo is not set.") \
+    def(JOB_MANAGER_SCORE_MANAGER_IS_NOT_SET, "ScoreManager is not set.") \
+    def(JOB_MANAGER_HAS_NO_JOB, "Job set is empty.") \
+    def(SCHEDULE_LENGTH_IS_INVALID, "Schedule length is invalid") \
+    def(POINT_SEQUENCE_IS_NOT_VALIDATED, \
+        "This sorted point sequence is not validated yet. Validate or fix " \
+        "the sequence data.")
+enum class CheckCode : int {
+#define def(x,m) x,
+    CHECK_CODES_
+#undef def
+};
+inline const char* check_code_to_str(CheckCode code) {
+#define def(x,m) m,
+    static constexpr const char* messages[] = {CHECK_CODES_};
+#undef def
+    return messages[static_cast<int>(code)];
+}
+#define RETURN_CHECK_CODE_IF(invalid_cond,code) \
     do { \
         if (invalid_cond) { \
-            v = false; \
-            if (m) { \
-                *(m) += format_str(__VA_ARGS__); \
-                *(m) += "\n"; \
-            } \
+            return CheckCode::code; \
+        } \
+    } while (0)
+#define RETURN_IF_CHECK_FAILED(...) \
+    do { \
+        CheckCode check_code_ = (__VA_ARGS__); \
+        if (check_code_ != CheckCode::OK) { \
+            return check_code_; \
         } \
     } while (0)
+inline bool report_check(CheckCode code, std::string* msg) {
+    if (msg) {
+        msg->clear();
+        if (code != CheckCode::OK) {
+            *msg += check_code_to_str(code);
+            *msg += "\n";
+        }
+    }
+    return code == CheckCode::OK;
+}
+class DiagnosticContext {
+    SourceLocation loc_;
+    const char* expr_ = nullptr;
+ public:
+    DiagnosticContext() = default;
+    DiagnosticContext(const SourceLocation& loc, const char* expr)
+        : loc_(loc), expr_(expr) {
+    }
+    std::string str() const {
+        if (expr_ == nullptr) {
+            return "";
+        }
+        return "\n" + loc_.str() + " " + expr_;
+    }
+};
 #endif
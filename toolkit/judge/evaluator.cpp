@@ -0,0 +1,414 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "error_check.hpp"
+#include "lib/cmdline.h"
+#include "lib/json.hpp"
+#include "solver.hpp"
+#include "solver_process.hpp"
+#include "turn_profiler.hpp"
+#include "world.hpp"
+struct EvaluationResult {
+    std::string testcase;
+    final_result_t score = 0;
+    WrongAnswerType wa_type = WrongAnswerType::INVALID;
+    std::string message;
+    double wall_time_ms = 0.0;
+    double solver_time_ms = 0.0;
+    double think_time_p50_ms = 0.0;
+    double think_time_p99_ms = 0.0;
+    double think_time_max_ms = 0.0;
+    bool has_baseline = false;
+    final_result_t baseline_score = 0;
+    bool differs_from_baseline() const {
+        return has_baseline && score != baseline_score;
+    }
+    friend void to_json(json_ref j, const EvaluationResult& r) {
+        j = json{
+            {"testcase", r.testcase},
+            {"score", r.score},
+            {"wa_type", r.wa_type == WrongAnswerType::INVALID
+                            ? ""
+                            : wa_type_to_str(r.wa_type)},
+            {"message", r.message},
+            {"wall_time_ms", r.wall_time_ms},
+            {"solver_time_ms", r.solver_time_ms},
+            {"think_time_p50_ms", r.think_time_p50_ms},
+            {"think_time_p99_ms", r.think_time_p99_ms},
+            {"think_time_max_ms", r.think_time_max_ms},
+        };
+        if (r.has_baseline) {
+            j["baseline_score"] = r.baseline_score;
+            j["score_diff"] = r.score - r.baseline_score;
+        }
+    }
+};
+struct EvaluationConfig {
+    std::string solver_command;
+    const SolverLibrary* solver_library = nullptr;
+    std::string replay_dir;
+    std::string log_dir;
+    std::string binary_log_dir;
+    std::string seekable_log_dir;
+    int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL;
+    std::string stderr_dir;
+    std::string transcript_dir;
+    SolverTimeLimit time_limit;
+    unsigned distance_thread_num = 0;
+};
+std::string case_stem(const std::string& path) {
+    return std::filesystem::path(path).stem().string();
+}
+final_result_t evaluate_world(const EvaluationConfig& config, World& world,
+                              const std::string& testcase,
+                              EvaluationResult& r) {
+    if (!config.replay_dir.empty()) {
+        auto path = std::filesystem::path(config.replay_dir) /
+                    std::filesystem::path(testcase).filename();
+        std::ifstream transcript(path);
+        THROW_RUNTIME_ERROR_IF(!transcript, "Failed to open the transcript:%s",
+                               path.c_str());
+        std::ostream null_os(nullptr);
+        return world.interact(transcript, null_os);
+    }
+    if (config.solver_library != nullptr) {
+        auto solver = config.solver_library->create();
+        return world.run(*solver);
+    }
+    SolverProcess solver(config.solver_command,
+                         config.stderr_dir.empty()
+                             ? "/dev/null"
+                             : (std::filesystem::path(config.stderr_dir) /
+                                (case_stem(testcase) + ".err"))
+                                   .string());
+    solver.set_time_limit(config.time_limit);
+    std::ofstream input_transcript;
+    std::ofstream output_transcript;
+    if (!config.transcript_dir.empty()) {
+        input_transcript.open(std::filesystem::path(config.transcript_dir) /
+                              (case_stem(testcase) + ".in"));
+        output_transcript.open(std::filesystem::path(config.transcript_dir) /
+                               std::filesystem::path(testcase).filename());
+        solver.set_transcript(&input_transcript, &output_transcript);
+    }
+    final_result_t score = solver.run(world);
+    auto sorted = solver.sorted_think_time_ns();
+    r.solver_time_ms = solver.waited_ns() * 1e-6;
+    r.think_time_p50_ms = nearest_rank(sorted, 50) * 1e-6;
+    r.think_time_p99_ms = nearest_rank(sorted, 99) * 1e-6;
+    r.think_time_max_ms = sorted.empty() ? 0.0 : sorted.back() * 1e-6;
+    return score;
+}
+EvaluationResult evaluate_case(const EvaluationConfig& config,
+                               const std::string& testcase) {
+    EvaluationResult r;
+    r.testcase = testcase;
+    auto begin = std::chrono::steady_clock::now();
+    try {
+        std::ifstream ifs(testcase);
+        THROW_RUNTIME_ERROR_IF(!ifs, "Failed to open the file:%s",
+                               testcase.c_str());
+        std::ofstream logofs;
+        std::ofstream binlogofs;
+        std::ofstream seeklogofs;
+        World world;
+        world.set_distance_thread_num(config.distance_thread_num);
+        if (!config.log_dir.empty()) {
+            logofs.open(std::filesystem::path(config.log_dir) /
+                        (case_stem(testcase) + ".json"));
+            world.set_json_log_output_stream(&logofs);
+        }
+        if (!config.binary_log_dir.empty()) {
+            binlogofs.open(std::filesystem::path(config.binary_log_dir) /
+                               (case_stem(testcase) + ".bin"),
+                           std::ios::binary);
+            world.set_binary_log_output_stream(&binlogofs);
+        }
+        if (!config.seekable_log_dir.empty()) {
+            seeklogofs.open(std::filesystem::path(config.seekable_log_dir) /
+                                (case_stem(testcase) + ".seek"),
+                            std::ios::binary);
+            world.set_seekable_log_output_stream(&seeklogofs,
+                                                 config.keyframe_interval);
+        }
+        world.initialize();
+        world.read_from_stream(ifs);
+        r.score = evaluate_world(config, world, testcase, r);
+    } catch (const WrongAnswerError& e) {
+        r.wa_type = e.type;
+        r.message = e.what();
+    } catch (const OutputError& e) {
+        r.wa_type = WrongAnswerType::OUTPUT_ERROR;
+        r.message = e.what();
+    } catch (const std::exception& e) {
+        r.wa_type = WrongAnswerType::UNKNOWN_ERROR;
+        r.message = e.what();
+    }
+    if (r.wa_type != WrongAnswerType::INVALID) {
+        r.score = wa_type_to_result(r.wa_type);
+    }
+    r.wall_time_ms = std::chrono::duration<double, std::milli>(
+                         std::chrono::steady_clock::now() - begin)
+                         .count();
+    return r;
+}
+std::vector<std::string> collect_testcases(const std::vector<std::string>& args) {
+    std::vector<std::string> ret;
+    for (const auto& a : args) {
+        if (std::filesystem::is_directory(a)) {
+            std::vector<std::string> files;
+            for (const auto& e : std::filesystem::directory_iterator(a)) {
+                if (e.is_regular_file()) {
+                    files.push_back(e.path().string());
+                }
+            }
+            std::sort(files.begin(), files.end());
+            ret.insert(ret.end(), files.begin(), files.end());
+        } else {
+            ret.push_back(a);
+        }
+    }
+    return ret;
+}
+std::map<std::string, final_result_t>
+read_baseline_scores(const std::string& path) {
+    std::ifstream ifs(path);
+    THROW_RUNTIME_ERROR_IF(!ifs, "Failed to open the file:%s", path.c_str());
+    std::map<std::string, final_result_t> ret;
+    std::string line;
+    std::getline(ifs, line);
+    while (std::getline(ifs, line)) {
+        std::string testcase;
+        size_t i = 0;
+        if (!line.empty() && line[0] == '"') {
+            for (i = 1; i < line.size(); i++) {
+                if (line[i] != '"') {
+                    testcase += line[i];
+                } else if (i + 1 < line.size() && line[i + 1] == '"') {
+                    testcase += line[++i];
+                } else {
+                    i++;
+                    break;
+                }
+            }
+        } else {
+            i = std::min(line.find(','), line.size());
+            testcase = line.substr(0, i);
+        }
+        THROW_RUNTIME_ERROR_IF(i >= line.size() || line[i] != ',',
+                               "Malformed line in the baseline:%s",
+                               line.c_str());
+        ret[case_stem(testcase)] = std::stoll(line.substr(i + 1));
+    }
+    return ret;
+}
+std::string csv_escape(const std::string& s) {
+    std::string ret = "\"";
+    for (char c : s) {
+        if (c == '"') {
+            ret += '"';
+        }
+        ret += c == '\n' ? ' ' : c;
+    }
+    return ret + "\"";
+}
+int main(int argc, char** argv) {
+    cmdline::parser p;
+    p.add<std::string>("solver", 's',
+                       "解答プログラムを実行するコマンド(/bin/sh -cで実行する)",
+                       false, "");
+    p.add<std::string>(
+        "solver-lib", 'L',
+        "ソルバの共有ライブラリ(HC2022_EXPORT_SOLVERでエクスポートしたもの)",
+        false, "");
+    p.add<std::string>("replay", 'r',
+                       "記録済みの解答プログラムの出力を再生する"
+                       "(<dir>/<テストケースのファイル名>を読む)",
+                       false, "");
+    p.add<std::string>("baseline", 'b',
+                       "比較対象の結果CSV(以前のevaluatorの出力)", false, "");
+    p.add<int>("jobs", 'j', "並列数(0:論理コア数)", false, 0);
+    p.add<std::string>("format", 'f', "出力形式", false, "csv",
+                       cmdline::oneof<std::string>("csv", "json"));
+    p.add<std::string>("output", 'o', "結果の出力先(省略時は標準出力)", false,
+                       "");
+    p.add<std::string>("log-dir", 'l',
+                       "ビジュアライザ用ログの出力先ディレクトリ", false, "");
+    p.add<std::string>("binary-log-dir", 'B',
+                       "カラム形式のバイナリログの出力先ディレクトリ", false,
+                       "");
+    p.add<std::string>("seekable-log-dir", 'k',
+                       "シーク可能なログの出力先ディレクトリ", false, "");
+    p.add<int>("keyframe-interval", 'K', "シーク可能なログのキーフレーム間隔",
+               false, DEFAULT_KEYFRAME_INTERVAL, cmdline::range(1, 1 << 30));
+    p.add<std::string>("stderr-dir", 'e',
+                       "解答プログラムの標準エラー出力の保存先ディレクトリ",
+                       false, "");
+    p.add<std::string>("transcript-dir", 'x',
+                       "解答プログラムの入出力の保存先ディレクトリ"
+                       "(出力は<dir>/<テストケースのファイル名>に保存され、"
+                       "--replayで再生できる)",
+                       false, "");
+    p.add<double>("turn-time-limit", 't',
+                  "1ターンあたりの制限時間[ms](0:無制限)", false, 0.0);
+    p.add<double>("time-limit", 'T',
+                  "解答プログラムの出力待ち時間の合計の制限[ms](0:無制限)",
+                  false, 0.0);
+    p.footer("<testcase file or directory>...");
+    p.parse_check(argc, argv);
+    EvaluationConfig config;
+    config.solver_command = p.get<std::string>("solver");
+    config.replay_dir = p.get<std::string>("replay");
+    config.log_dir = p.get<std::string>("log-dir");
+    config.binary_log_dir = p.get<std::string>("binary-log-dir");
+    config.seekable_log_dir = p.get<std::string>("seekable-log-dir");
+    config.keyframe_interval = p.get<int>("keyframe-interval");
+    config.stderr_dir = p.get<std::string>("stderr-dir");
+    config.transcript_dir = p.get<std::string>("transcript-dir");
+    config.time_limit = {p.get<double>("turn-time-limit"),
+                         p.get<double>("time-limit")};
+    SolverLibrary lib;
+    if (!p.get<std::string>("solver-lib").empty()) {
+        lib.open(p.get<std::string>("solver-lib"));
+        config.solver_library = &lib;
+    }
+    if (!config.solver_command.empty() + (config.solver_library != nullptr) +
+            !config.replay_dir.empty() !=
+        1) {
+        std::cerr << "Specify exactly one of --solver, --solver-lib and "
+                     "--replay."
+                  << std::endl
+                  << p.usage();
+        return 1;
+    }
+    std::map<std::string, final_result_t> baseline;
+    if (!p.get<std::string>("baseline").empty()) {
+        baseline = read_baseline_scores(p.get<std::string>("baseline"));
+    }
+    const auto testcases = collect_testcases(p.rest());
+    if (testcases.empty()) {
+        std::cerr << p.usage();
+        return 1;
+    }
+    for (const auto& dir :
+         {config.log_dir, config.binary_log_dir, config.seekable_log_dir,
+          config.stderr_dir, config.transcript_dir}) {
+        if (!dir.empty()) {
+            std::filesystem::create_directories(dir);
+        }
+    }
+    signal(SIGPIPE, SIG_IGN);
+    int jobs = p.get<int>("jobs");
+    if (jobs <= 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    jobs = std::min<int>(jobs, testcases.size());
+    // Cases already run in parallel, so each one computes distances serially.
+    config.distance_thread_num = jobs > 1 ? 1 : 0;
+    std::vector<EvaluationResult> results(testcases.size());
+    std::atomic<size_t> next{0};
+    std::mutex progress_mtx;
+    size_t done = 0;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < jobs; i++) {
+        threads.emplace_back([&] {
+            for (size_t k = next++; k < testcases.size(); k = next++) {
+                results[k] = evaluate_case(config, testcases[k]);
+                auto it = baseline.find(case_stem(testcases[k]));
+                if (it != baseline.end()) {
+                    results[k].has_baseline = true;
+                    results[k].baseline_score = it->second;
+                }
+                std::lock_guard<std::mutex> lk(progress_mtx);
+                std::cerr << "[" << ++done << "/" << testcases.size() << "] "
+                          << results[k].testcase << " " << results[k].score
+                          << std::endl;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    double log_sum = 0.0;
+    int accepted_num = 0;
+    for (const auto& r : results) {
+        if (r.wa_type == WrongAnswerType::INVALID && r.score > 0) {
+            log_sum += std::log10(static_cast<double>(r.score));
+            accepted_num++;
+        }
+    }
+    double mean_log10 = accepted_num == 0 ? 0.0 : log_sum / accepted_num;
+    int compared_num = 0;
+    int differed_num = 0;
+    for (const auto& r : results) {
+        compared_num += r.has_baseline;
+        differed_num += r.differs_from_baseline();
+    }
+    std::ofstream ofs;
+    if (!p.get<std::string>("output").empty()) {
+        ofs.open(p.get<std::string>("output"));
+    }
+    std::ostream& out = ofs.is_open() ? ofs : std::cout;
+    if (p.get<std::string>("format") == "json") {
+        out << json{
+                   {"cases", results},
+                   {"case_num", results.size()},
+                   {"accepted_num", accepted_num},
+                   {"mean_log10_score", mean_log10},
+                   {"compared_num", compared_num},
+                   {"differed_num", differed_num},
+               }.dump(1)
+            << std::endl;
+    } else {
+        out << std::fixed << std::setprecision(3);
+        out << "testcase,score,wa_type,wall_time_ms,solver_time_ms,"
+               "think_time_p50_ms,think_time_p99_ms,think_time_max_ms"
+            << (baseline.empty() ? "" : ",baseline_score,score_diff")
+            << std::endl;
+        for (const auto& r : results) {
+            out << csv_escape(r.testcase) << "," << r.score << ","
+                << (r.wa_type == WrongAnswerType::INVALID
+                        ? ""
+                        : wa_type_to_str(r.wa_type))
+                << "," << r.wall_time_ms << "," << r.solver_time_ms << ","
+                << r.think_time_p50_ms << "," << r.think_time_p99_ms << ","
+                << r.think_time_max_ms;
+            if (!baseline.empty()) {
+                out << ",";
+                if (r.has_baseline) {
+                    out << r.baseline_score << ","
+                        << r.score - r.baseline_score;
+                } else {
+                    out << ",";
+                }
+            }
+            out << std::endl;
+        }
+    }
+    std::cerr << "mean log10 score:" << mean_log10 << " (" << accepted_num
+              << "/" << results.size() << " cases accepted)" << std::endl;
+    if (!baseline.empty()) {
+        for (const auto& r : results) {
+            if (r.differs_from_baseline()) {
+                std::cerr << "score changed:" << r.testcase << " "
+                          << r.baseline_score << " -> " << r.score
+                          << std::endl;
+            }
+        }
+        std::cerr << differed_num << "/" << compared_num
+                  << " cases differ from the baseline" << std::endl;
+        return differed_num == 0 ? 0 : 2;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "exact_score.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include "boost/multiprecision/cpp_int.hpp"
+#include "error_check.hpp"
+#include "snapshot.hpp"
+namespace {
+using boost::multiprecision::cpp_int;
+using boost::multiprecision::cpp_rational;
+__int128 floor_div_(__int128 a, int64_t b) {
+    __int128 q = a / b;
+    if (q * b != a && a < 0) {
+        q--;
+    }
+    return q;
+}
+cpp_int to_cpp_int_(__int128 v) {
+    cpp_int ret = static_cast<int64_t>(v >> 32);
+    ret <<= 32;
+    ret += static_cast<uint32_t>(v & 0xffffffff);
+    return ret;
+}
+int64_t floor_to_int64_(const cpp_rational& v) {
+    const cpp_int n = numerator(v);
+    const cpp_int d = denominator(v);
+    cpp_int q = n / d;
+    if (n < 0 && q * d != n) {
+        q--;
+    }
+    THROW_RUNTIME_ERROR_IF(q > std::numeric_limits<int64_t>::max() ||
+                               q < std::numeric_limits<int64_t>::lowest(),
+                           "Score is out of the int64 range.");
+    return q.convert_to<int64_t>();
+}
+cpp_rational fraction_sum_(
+    const std::vector<std::pair<int64_t, int64_t>>& fractions) {
+    cpp_rational ret = 0;
+    for (const auto& [den, rem] : fractions) {
+        ret += cpp_rational(cpp_int(rem), cpp_int(den));
+    }
+    return ret;
+}
+}
+void ExactScore::add_fraction_(int64_t den, __int128 rem) {
+    const __int128 q = floor_div_(rem, den);
+    whole_ += q;
+    rem -= q * den;
+    if (rem == 0) {
+        return;
+    }
+    auto it = std::lower_bound(
+        fractions_.begin(), fractions_.end(), den,
+        [](const std::pair<int64_t, int64_t>& f, int64_t d) {
+            return f.first < d;
+        });
+    if (it == fractions_.end() || it->first != den) {
+        fractions_.insert(it, {den, static_cast<int64_t>(rem)});
+        return;
+    }
+    it->second += static_cast<int64_t>(rem);
+    if (it->second >= den) {
+        it->second -= den;
+        whole_++;
+        if (it->second == 0) {
+            fractions_.erase(it);
+        }
+    }
+}
+ExactScore ExactScore::ratio(__int128 num, int64_t den) {
+    THROW_LOGIC_ERROR_IF(den <= 0, "Denominator must be positive.");
+    ExactScore ret;
+    ret.add_fraction_(den, num);
+    return ret;
+}
+ExactScore& ExactScore::operator+=(const ExactScore& s) {
+    whole_ += s.whole_;
+    for (const auto& [den, rem] : s.fractions_) {
+        add_fraction_(den, rem);
+    }
+    return *this;
+}
+ExactScore ExactScore::operator*(int64_t k) const {
+    ExactScore ret;
+    ret.whole_ = whole_ * k;
+    for (const auto& [den, rem] : fractions_) {
+        ret.add_fraction_(den, static_cast<__int128>(rem) * k);
+    }
+    return ret;
+}
+int ExactScore::sign() const {
+    if (whole_ >= 0) {
+        return whole_ > 0 || !fractions_.empty() ? 1 : 0;
+    }
+    // A single fraction is below 1, so it cannot lift a negative whole part.
+    if (fractions_.size() <= 1) {
+        return -1;
+    }
+    const cpp_rational v = to_cpp_int_(whole_) + fraction_sum_(fractions_);
+    return v.sign();
+}
+int64_t ExactScore::floor() const {
+    return floor_to_int64_(to_cpp_int_(whole_) + fraction_sum_(fractions_));
+}
+int64_t ExactScore::floor_scaled(double coeff) const {
+    THROW_LOGIC_ERROR_IF(!std::isfinite(coeff), "Coefficient is not finite.");
+    int exponent;
+    const double mantissa = std::frexp(coeff, &exponent);
+    cpp_rational c =
+        cpp_int(static_cast<int64_t>(std::ldexp(mantissa, 53)));
+    exponent -= 53;
+    if (exponent > 0) {
+        c *= cpp_rational(cpp_int(1) << exponent);
+    } else if (exponent < 0) {
+        c /= cpp_rational(cpp_int(1) << -exponent);
+    }
+    return floor_to_int64_(
+        (to_cpp_int_(whole_) + fraction_sum_(fractions_)) * c);
+}
+float_score_t ExactScore::to_float_score() const {
+    float_score_t ret;
+    if (whole_ == static_cast<int64_t>(whole_)) {
+        ret = static_cast<int64_t>(whole_);
+    } else {
+        ret = static_cast<int64_t>(whole_ >> 32);
+        ret = ldexp(ret, 32);
+        ret += static_cast<uint32_t>(whole_ & 0xffffffff);
+    }
+    for (const auto& [den, rem] : fractions_) {
+        ret += float_score_t(rem) / den;
+    }
+    return ret;
+}
+std::string ExactScore::str() const {
+    return to_float_score().str();
+}
+void ExactScore::snapshot(SnapshotWriter& w) const {
+    w.write(whole_);
+    w.write_sequence(fractions_);
+}
+void ExactScore::restore(SnapshotReader& r) {
+    r.read(whole_);
+    r.read_sequence(fractions_);
+}
+std::ostream& operator<<(std::ostream& os, const ExactScore& s) {
+    return os << s.str();
+}
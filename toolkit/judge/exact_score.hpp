@@ -0,0 +1,37 @@
+#ifndef HEADER_2HC2022_EXACT_SCORE
+#define HEADER_2HC2022_EXACT_SCORE 
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <utility>
+#include <vector>
+#include "defines.hpp"
+class SnapshotReader;
+class SnapshotWriter;
+// An exact rational score kept as whole_ + sum(rem / den) with
+// 0 <= rem < den. Gains are linear interpolations between integer points, so
+// the denominators are the segment lengths of the gain functions and only a
+// few distinct ones ever appear.
+class ExactScore {
+    __int128 whole_ = 0;
+    std::vector<std::pair<int64_t, int64_t>> fractions_;
+    void add_fraction_(int64_t den, __int128 rem);
+ public:
+    ExactScore() = default;
+    ExactScore(int64_t v) : whole_(v) {
+    }
+    // num / den (den > 0).
+    static ExactScore ratio(__int128 num, int64_t den);
+    ExactScore& operator+=(const ExactScore& s);
+    ExactScore operator*(int64_t k) const;
+    int sign() const;
+    int64_t floor() const;
+    // floor(value * coeff), with coeff taken as the exact value of the double.
+    int64_t floor_scaled(double coeff) const;
+    float_score_t to_float_score() const;
+    std::string str() const;
+    void snapshot(SnapshotWriter& w) const;
+    void restore(SnapshotReader& r);
+};
+std::ostream& operator<<(std::ostream& os, const ExactScore& s);
+#endif
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+#include "boost/multiprecision/cpp_int.hpp"
+#include "exact_score.hpp"
+#include "lib/cmdline.h"
+#include "piecewise_function.hpp"
+// Differential check of ExactScore against boost::multiprecision::cpp_rational
+// and against the cpp_bin_float_quad arithmetic the judge used before.
+// Gains come from random reward functions shaped like the generator's.
+using boost::multiprecision::cpp_int;
+using boost::multiprecision::cpp_rational;
+namespace {
+struct CaseResult {
+    bool exact_ok = true;
+    int64_t quad_floor_diff = 0;
+    int64_t quad_scaled_diff = 0;
+};
+cpp_int floor_(const cpp_rational& v) {
+    const cpp_int n = numerator(v);
+    const cpp_int d = denominator(v);
+    cpp_int q = n / d;
+    if (n < 0 && q * d != n) {
+        q--;
+    }
+    return q;
+}
+cpp_rational exact_double_(double c) {
+    int exponent;
+    const double mantissa = std::frexp(c, &exponent);
+    cpp_rational ret = cpp_int(static_cast<int64_t>(std::ldexp(mantissa, 53)));
+    exponent -= 53;
+    if (exponent > 0) {
+        ret *= cpp_rational(cpp_int(1) << exponent);
+    } else if (exponent < 0) {
+        ret /= cpp_rational(cpp_int(1) << -exponent);
+    }
+    return ret;
+}
+// The interpolation that piecewise_linear_function did with float_score_t.
+float_score_t quad_gain_(const sorted_point_sequence& f, discrete_time_t t) {
+    auto it = f.begin();
+    while (it != f.end() && it->first <= t) {
+        ++it;
+    }
+    if (it == f.begin()) {
+        return f[0].second;
+    }
+    if (it == f.end()) {
+        return f.back().second;
+    }
+    auto [t2, v2] = *it;
+    auto [t1, v1] = *--it;
+    return (float_score_t{v2} - float_score_t{v1}) *
+               (float_score_t{t} - float_score_t{t1}) /
+               (float_score_t{t2} - float_score_t{t1}) +
+           float_score_t{v1};
+}
+cpp_rational rational_gain_(const sorted_point_sequence& f,
+                            discrete_time_t t) {
+    auto it = f.begin();
+    while (it != f.end() && it->first <= t) {
+        ++it;
+    }
+    if (it == f.begin()) {
+        return f[0].second;
+    }
+    if (it == f.end()) {
+        return f.back().second;
+    }
+    auto [t2, v2] = *it;
+    auto [t1, v1] = *--it;
+    return cpp_rational(cpp_int(v2 - v1) * (t - t1), cpp_int(t2 - t1)) + v1;
+}
+sorted_point_sequence random_reward_function_(std::mt19937_64& rng,
+                                              discrete_time_t t_max,
+                                              bool allow_negative) {
+    std::uniform_int_distribution<int> n_dist(2, 12);
+    std::uniform_int_distribution<discrete_time_t> step_dist(1, 60);
+    std::uniform_int_distribution<simple_score_t> v_dist(
+        allow_negative ? -10000000 : 1, 10000000);
+    sorted_point_sequence f;
+    discrete_time_t t = std::uniform_int_distribution<discrete_time_t>(
+        0, t_max / 2)(rng);
+    const int n = n_dist(rng);
+    for (int i = 0; i < n && t <= t_max; i++) {
+        f.emplace_back(t, v_dist(rng));
+        t += step_dist(rng);
+    }
+    f.validate();
+    return f;
+}
+CaseResult run_case_(std::mt19937_64& rng, bool allow_negative) {
+    const discrete_time_t t_max = 1000;
+    const int job_num = std::uniform_int_distribution<int>(1, 200)(rng);
+    ExactScore exact;
+    cpp_rational reference = 0;
+    float_score_t quad = 0;
+    for (int j = 0; j < job_num; j++) {
+        const auto f = random_reward_function_(rng, t_max, allow_negative);
+        std::uniform_int_distribution<discrete_time_t> t_dist(
+            f[0].first - 5, f.back().first + 5);
+        const int task_num = std::uniform_int_distribution<int>(1, 30)(rng);
+        ExactScore exact_jobwise;
+        float_score_t quad_jobwise = 0;
+        for (int k = 0; k < task_num; k++) {
+            const discrete_time_t t = t_dist(rng);
+            const int64_t w = std::uniform_int_distribution<int>(1, 5)(rng);
+            exact_jobwise += piecewise_linear_function(f, t) * w;
+            reference += rational_gain_(f, t) * w;
+            quad_jobwise += quad_gain_(f, t) * w;
+        }
+        exact += exact_jobwise;
+        quad += quad_jobwise;
+    }
+    // Land on an integer now and then; that is where rounding bites.
+    if (rng() % 4 == 0) {
+        const cpp_rational frac = reference - floor_(reference);
+        const cpp_int den = denominator(frac);
+        if (den <= std::numeric_limits<int64_t>::max()) {
+            const int64_t d = den.convert_to<int64_t>();
+            const int64_t n = (d - numerator(frac)).convert_to<int64_t>();
+            exact += ExactScore::ratio(n, d);
+            reference += cpp_rational(cpp_int(n), den);
+            quad += float_score_t(n) / d;
+        }
+    }
+    double coeff = std::uniform_real_distribution<double>(0.5, 1.0)(rng);
+    const int unfinished = std::uniform_int_distribution<int>(0, 50)(rng);
+    for (int i = 0; i < unfinished; i++) {
+        coeff *= std::uniform_real_distribution<double>(0.9, 1.0)(rng);
+    }
+    if (rng() % 8 == 0) {
+        coeff = 1.0;
+    }
+    CaseResult ret;
+    const cpp_int ref_floor = floor_(reference);
+    const cpp_int ref_scaled = floor_(reference * exact_double_(coeff));
+    if (exact.sign() != reference.sign() || exact.floor() != ref_floor ||
+        exact.floor_scaled(coeff) != ref_scaled) {
+        ret.exact_ok = false;
+        std::fprintf(stderr, "mismatch: exact=%s floor=%lld scaled=%lld\n",
+                     exact.str().c_str(),
+                     static_cast<long long>(exact.floor()),
+                     static_cast<long long>(exact.floor_scaled(coeff)));
+    }
+    using std::floor;
+    ret.quad_floor_diff =
+        static_cast<int64_t>(floor(quad)) - ref_floor.convert_to<int64_t>();
+    ret.quad_scaled_diff = static_cast<int64_t>(floor(quad * coeff)) -
+                           ref_scaled.convert_to<int64_t>();
+    return ret;
+}
+}
+int main(int argc, char** argv) {
+    cmdline::parser p;
+    p.add<int>("cases", 'n', "テストケース数", false, 2000);
+    p.add<uint64_t>("seed", 's', "乱数のシード", false, 1);
+    p.parse_check(argc, argv);
+    const int n = p.get<int>("cases");
+    std::mt19937_64 rng(p.get<uint64_t>("seed"));
+    int exact_mismatch = 0;
+    int quad_floor_diff = 0;
+    int quad_scaled_diff = 0;
+    int64_t quad_max_diff = 0;
+    for (int i = 0; i < n; i++) {
+        const CaseResult r = run_case_(rng, i % 2 == 1);
+        exact_mismatch += !r.exact_ok;
+        quad_floor_diff += r.quad_floor_diff != 0;
+        quad_scaled_diff += r.quad_scaled_diff != 0;
+        quad_max_diff = std::max({quad_max_diff, std::abs(r.quad_floor_diff),
+                                  std::abs(r.quad_scaled_diff)});
+    }
+    std::printf("%d cases, %d ExactScore mismatches\n", n, exact_mismatch);
+    std::printf("cpp_bin_float_quad path: floor differs in %d, "
+                "floor_scaled differs in %d (max |diff| %lld)\n",
+                quad_floor_diff, quad_scaled_diff,
+                static_cast<long long>(quad_max_diff));
+    return exact_mismatch == 0 && quad_max_diff <= 1 ? 0 : 1;
+}
@@ -1,13 +1,69 @@
 #include "graph.hpp"
 #include <algorithm>
+#include <atomic>
+#include <functional>
+#include <numeric>
 #include <queue>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
 #include "error_check.hpp"
 #include "io.hpp"
 #include "lib/json.hpp"
 #include "logger.hpp"
+namespace {
+// Runs worker on thread_num threads (including the calling one).
+void run_workers_(unsigned thread_num, const std::function<void()>& worker) {
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_num; i++) {
+        threads.emplace_back(worker);
+    }
+    worker();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+// Monotone priority queue for non-negative integer keys: an entry sits in the
+// bucket indexed by the highest bit in which its key differs from the last
+// popped key, and each entry moves to lower buckets at most 64 times.
+class RadixHeap_ {
+    std::vector<std::pair<distance_t, vertex_index_t>> buckets_[65];
+    distance_t last_ = 0;
+    size_t size_ = 0;
+    static int bucket_of_(distance_t x) {
+        return x == 0 ? 0 : 64 - __builtin_clzll(x);
+    }
+ public:
+    bool empty() const {
+        return size_ == 0;
+    }
+    void push(distance_t key, vertex_index_t v) {
+        buckets_[bucket_of_(key ^ last_)].emplace_back(key, v);
+        size_++;
+    }
+    std::pair<distance_t, vertex_index_t> pop() {
+        if (buckets_[0].empty()) {
+            int i = 1;
+            while (buckets_[i].empty()) {
+                i++;
+            }
+            last_ = std::min_element(buckets_[i].begin(), buckets_[i].end())
+                        ->first;
+            for (const auto& e : buckets_[i]) {
+                buckets_[bucket_of_(e.first ^ last_)].push_back(e);
+            }
+            buckets_[i].clear();
+        }
+        const auto ret = buckets_[0].back();
+        buckets_[0].pop_back();
+        if (--size_ == 0) {
+            last_ = 0;
+        }
+        return ret;
+    }
+};
+}
 Edge::Edge() = default;
 Edge::Edge(vertex_index_t from_, vertex_index_t to_, distance_t d_)
     : from(from_), to(to_), d(d_) {
@@ -165,7 +221,8 @@ void UndirectedGraph::read_graph(std::istream& is) {
     ValueReader r(is);
     graph_loaded_ = false;
     edges_.clear();
-    organized_edges_.clear();
+    adj_offsets_.clear();
+    adj_.clear();
     readline_exact(r,
                    TAG(ValueGroup::POSITIVE_COUNT, N_V),
                    TAG(ValueGroup::NON_NEGATIVE_COUNT, N_E));
@@ -197,9 +254,17 @@ void UndirectedGraph::read_graph(std::istream& is) {
         edges_.emplace_back(std::move(e));
         edges_.emplace_back(std::move(e2));
     }
-    organized_edges_.resize(N_V);
+    adj_offsets_.assign(N_V + 1, 0);
+    for (const auto& e : edges_) {
+        adj_offsets_[e.from + 1]++;
+    }
+    for (int i = 0; i < N_V; i++) {
+        adj_offsets_[i + 1] += adj_offsets_[i];
+    }
+    adj_.resize(edges_.size());
+    std::vector<int> pos(adj_offsets_.begin(), adj_offsets_.end() - 1);
     for (auto [a, b, d] : edges_) {
-        organized_edges_[a].emplace_back(d, b);
+        adj_[pos[a]++] = {d, b};
     }
     graph_loaded_ = true;
     INFO("Graph data loaded succesfully.");
@@ -207,7 +272,77 @@ void UndirectedGraph::read_graph(std::istream& is) {
 bool UndirectedGraph::is_graph_loaded() const {
     return graph_loaded_;
 }
-void UndirectedGraph::compute_distance_info() {
+uint8_t UndirectedGraph::first_move_via_(vertex_index_t origin,
+                                        vertex_index_t u, int i,
+                                        const uint8_t* first) const {
+    return u == origin ? i - adj_offsets_[u] : first[u];
+}
+void UndirectedGraph::bucket_dijkstra_(
+    vertex_index_t origin, distance_t* dist,
+    std::vector<std::vector<vertex_index_t>>& buckets, uint8_t* first) const {
+    // Dial's algorithm: every tentative distance lies in
+    // [cur, cur + max weight], so a circular array of max weight + 1 buckets
+    // holds them without collisions. Edge weights are positive, so relaxing
+    // never pushes into the bucket being scanned.
+    const distance_t n_buckets = buckets.size();
+    dist[origin] = 0;
+    buckets[0].push_back(origin);
+    size_t pending = 1;
+    for (distance_t cur = 0; pending > 0; cur++) {
+        auto& bucket = buckets[cur % n_buckets];
+        for (vertex_index_t u : bucket) {
+            if (dist[u] != cur) {
+                continue;
+            }
+            for (int i = adj_offsets_[u]; i < adj_offsets_[u + 1]; i++) {
+                const auto [w, to] = adj_[i];
+                if (dist[to] > cur + w) {
+                    dist[to] = cur + w;
+                    buckets[(cur + w) % n_buckets].push_back(to);
+                    pending++;
+                    if (first) {
+                        first[to] = first_move_via_(origin, u, i, first);
+                    }
+                } else if (first) {
+                    const uint8_t via = first_move_via_(origin, u, i, first);
+                    first[to] = dist[to] == cur + w && via < first[to]
+                                    ? via
+                                    : first[to];
+                }
+            }
+        }
+        pending -= bucket.size();
+        bucket.clear();
+    }
+}
+void UndirectedGraph::radix_dijkstra_(vertex_index_t origin,
+                                      distance_t* dist,
+                                      uint8_t* first) const {
+    RadixHeap_ q;
+    dist[origin] = 0;
+    q.push(0, origin);
+    while (!q.empty()) {
+        auto [d, u] = q.pop();
+        if (dist[u] < d) {
+            continue;
+        }
+        for (int i = adj_offsets_[u]; i < adj_offsets_[u + 1]; i++) {
+            const auto [w, to] = adj_[i];
+            if (dist[to] > d + w) {
+                dist[to] = d + w;
+                q.push(dist[to], to);
+                if (first) {
+                    first[to] = first_move_via_(origin, u, i, first);
+                }
+            } else if (first) {
+                const uint8_t via = first_move_via_(origin, u, i, first);
+                first[to] =
+                    dist[to] == d + w && via < first[to] ? via : first[to];
+            }
+        }
+    }
+}
+void UndirectedGraph::compute_distance_info(unsigned thread_num) {
     THROW_LOGIC_ERROR_IF(!is_graph_loaded(), "Graph data is not loaded.");
     if (distances_computed_) {
         INFO("The distances are already computed.");
@@ -215,63 +350,174 @@ void UndirectedGraph::compute_distance_info() {
     }
     INFO("Computing distance info...");
     distances_computed_ = false;
-    using dv_pair = std::pair<distance_t, vertex_index_t>;
-    constexpr distance_t IMPOSSIBLE_LARGE_DISTANCE = MAX_DISTANCE + 1;
-    dist_mat_.resize(N_V * N_V);
-    std::fill(dist_mat_.begin(), dist_mat_.end(), IMPOSSIBLE_LARGE_DISTANCE);
-    std::queue<vertex_index_t> q;
-    for (vertex_index_t origin = 0; origin < N_V; origin++) {
-        distance_t* dist = &dist_mat_[N_V * origin];
-        dist[origin] = 0;
-        q.push(origin);
-        while (!q.empty()) {
-            vertex_index_t t = q.front();
-            q.pop();
-            for (auto e : organized_edges_[t]) {
-                if (dist[e.second] > dist[t] + e.first) {
-                    dist[e.second] = dist[t] + e.first;
-                    q.push(e.second);
-                }
+    constexpr distance_t UNREACHABLE = DistanceMatrix::UNREACHABLE;
+    distance_t max_weight = 0;
+    for (const auto& e : adj_) {
+        max_weight = std::max(max_weight, e.first);
+    }
+    // Buckets are scanned up to the eccentricity of the origin, which is at
+    // most (N_V - 1) * max_weight; use them while that stays within a small
+    // multiple of the relaxation work per origin.
+    const bool use_buckets =
+        max_weight <= 8 * (1 + static_cast<distance_t>(adj_.size()) / N_V);
+    auto search = [&](vertex_index_t origin, distance_t* dist,
+                      std::vector<std::vector<vertex_index_t>>& buckets,
+                      uint8_t* first) {
+        if (use_buckets) {
+            bucket_dijkstra_(origin, dist, buckets, first);
+        } else {
+            radix_dijkstra_(origin, dist, first);
+        }
+    };
+    // Any distance in a component is at most twice the eccentricity of one
+    // of its vertices, which bounds the cell width of the matrix.
+    {
+        std::vector<distance_t> dist(N_V, UNREACHABLE);
+        std::vector<std::vector<vertex_index_t>> buckets(
+            use_buckets ? max_weight + 1 : 0);
+        for (vertex_index_t root = 0; root < N_V; root++) {
+            if (dist[root] == UNREACHABLE) {
+                search(root, dist.data(), buckets, nullptr);
             }
         }
+        const distance_t max_finite =
+            *std::max_element(dist.begin(), dist.end());
+        dist_mat_.reset(N_V, 2 * std::min(max_finite, MAX_DISTANCE / 2));
+    }
+    // Searches start only from a vertex cover. The remaining vertices form an
+    // independent set, and a shortest path from such a vertex v leaves it
+    // through a covered neighbor n, so row v is the minimum of w(v, n) + row n.
+    std::vector<vertex_index_t> order(N_V);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](vertex_index_t a, vertex_index_t b) {
+                         return adj_offsets_[a + 1] - adj_offsets_[a] <
+                                adj_offsets_[b + 1] - adj_offsets_[b];
+                     });
+    std::vector<vertex_index_t> covered;
+    std::vector<vertex_index_t> independent;
+    std::vector<bool> taken(N_V, false);
+    std::vector<bool> in_cover(N_V, false);
+    for (vertex_index_t v : order) {
+        if (taken[v]) {
+            continue;
+        }
+        taken[v] = true;
+        independent.push_back(v);
+        for (int i = adj_offsets_[v]; i < adj_offsets_[v + 1]; i++) {
+            const vertex_index_t to = adj_[i].second;
+            if (!taken[to]) {
+                taken[to] = true;
+                in_cover[to] = true;
+                covered.push_back(to);
+            }
+        }
+    }
+    // The searches also record first moves: a vertex reached through u
+    // inherits u's first slot, and equal-length paths keep the smaller slot.
+    int max_degree = 0;
+    for (vertex_index_t u = 0; u < N_V; u++) {
+        max_degree =
+            std::max(max_degree, adj_offsets_[u + 1] - adj_offsets_[u]);
+    }
+    first_moves_.clear();
+    if (max_degree < NO_FIRST_MOVE) {
+        first_moves_.assign(static_cast<size_t>(N_V) * N_V, NO_FIRST_MOVE);
     }
+    auto first_move_row = [&](vertex_index_t u) {
+        return first_moves_.empty()
+                   ? nullptr
+                   : &first_moves_[static_cast<size_t>(N_V) * u];
+    };
+    if (thread_num == 0) {
+        thread_num = std::max(1u, std::thread::hardware_concurrency());
+    }
+    // Below this many origins per thread, spawning costs more than it saves.
+    constexpr int MIN_ORIGINS_PER_THREAD = 64;
+    thread_num = std::min<unsigned>(
+        thread_num, std::max(1, N_V / MIN_ORIGINS_PER_THREAD));
+    // In the triangular layout each cell is written by one row only: a pair
+    // of covered vertices by the smaller one, a covered-independent pair by
+    // the covered one.
+    constexpr bool TRIANGULAR = DistanceMatrix::TRIANGULAR;
+    std::atomic<size_t> next{0};
+    run_workers_(thread_num, [&] {
+        std::vector<distance_t> dist(N_V);
+        std::vector<std::vector<vertex_index_t>> buckets(
+            use_buckets ? max_weight + 1 : 0);
+        for (size_t k = next++; k < covered.size(); k = next++) {
+            const vertex_index_t u = covered[k];
+            std::fill(dist.begin(), dist.end(), UNREACHABLE);
+            search(u, dist.data(), buckets, first_move_row(u));
+            for (vertex_index_t v = 0; v < N_V; v++) {
+                if (!TRIANGULAR || v >= u || !in_cover[v]) {
+                    dist_mat_.set(u, v, dist[v]);
+                }
+            }
+        }
+    });
+    next = 0;
+    run_workers_(thread_num, [&] {
+        std::vector<distance_t> dist(N_V);
+        std::vector<distance_t> dist_to(N_V);
+        for (size_t k = next++; k < independent.size(); k = next++) {
+            const vertex_index_t u = independent[k];
+            uint8_t* first = first_move_row(u);
+            std::fill(dist.begin(), dist.end(), UNREACHABLE);
+            for (int i = adj_offsets_[u]; i < adj_offsets_[u + 1]; i++) {
+                const auto [w, to] = adj_[i];
+                const uint8_t slot = i - adj_offsets_[u];
+                dist_mat_.read_row(to, dist_to.data());
+                for (int v = 0; v < N_V; v++) {
+                    if (dist_to[v] + w < dist[v]) {
+                        dist[v] = dist_to[v] + w;
+                        if (first) {
+                            first[v] = slot;
+                        }
+                    }
+                }
+            }
+            dist[u] = 0;
+            if (first) {
+                first[u] = NO_FIRST_MOVE;
+            }
+            for (vertex_index_t v = 0; v < N_V; v++) {
+                if (!TRIANGULAR || (v >= u && !in_cover[v])) {
+                    dist_mat_.set(u, v, dist[v]);
+                }
+            }
+        }
+    });
     distances_computed_ = true;
     INFO("Done.");
 }
 bool UndirectedGraph::is_distance_info_computed() const {
     return distances_computed_;
 }
+const DistanceMatrix& UndirectedGraph::distance_matrix() const {
+    THROW_LOGIC_ERROR_IF(!is_distance_info_computed(),
+                         "Distances are not computed.");
+    return dist_mat_;
+}
+CheckCode UndirectedGraph::check_position(const Position& p) const {
+    RETURN_IF_CHECK_FAILED(p.check());
+    RETURN_CHECK_CODE_IF(p.u >= N_V, POSITION_U_IS_OUT_OF_RANGE);
+    RETURN_CHECK_CODE_IF(p.v >= N_V, POSITION_V_IS_OUT_OF_RANGE);
+    const distance_t d = distance(p.u, p.v);
+    RETURN_CHECK_CODE_IF(d == INVALID_DISTANCE, POSITION_IS_NOT_CONNECTED);
+    RETURN_CHECK_CODE_IF(p.distance_from_u > d,
+                         POSITION_DISTANCE_IS_TOO_LARGE);
+    RETURN_CHECK_CODE_IF(p.u != p.v && (d == p.distance_from_u || d == 0),
+                         POSITION_IS_NOT_ON_EDGE);
+    return CheckCode::OK;
+}
 bool UndirectedGraph::is_position_valid(const Position& p,
                                         std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    {
-        std::string pmsg;
-        VALIDITY_CHECK_WITH_MSG(
-            p.is_broken(&pmsg), valid, msg,
-            "The position is broken for the following reason(s):%s",
-            pmsg.c_str());
-    }
-    VALIDITY_CHECK_WITH_MSG(
-        p.u >= N_V, valid, msg,
-        "u is out of range (too large: internal u(%d) >= N_V(%d)).", p.u, N_V);
-    VALIDITY_CHECK_WITH_MSG(
-        p.v >= N_V, valid, msg,
-        "v is out of range (too large: internal v(%d) >= N_V(%d)).", p.v, N_V);
-    if (!valid) {
-        return valid;
-    }
-    VALIDITY_CHECK_WITH_MSG(distance(p.u, p.v) == INVALID_DISTANCE, valid, msg,
-                            "p.u and p.v is not connected.");
-    VALIDITY_CHECK_WITH_MSG(p.distance_from_u > distance(p.u, p.v), valid, msg,
-                            "The distance is too large:%d > %d",
-                            p.distance_from_u, distance(p.u, p.v));
-    VALIDITY_CHECK_WITH_MSG(
-        p.u != p.v && (distance(p.u, p.v) == p.distance_from_u ||
-                       distance(p.u, p.v) == 0),
-        valid, msg, "Exact vertex but p.u(internal:%d) != p.v(internal:%d)",
-        p.u, p.v);
+    const bool valid = report_check(check_position(p), msg);
+    if (!valid && msg) {
+        *msg += format_str("(position:%s, N_V:%d)\n",
+                           stream_to_string(p).c_str(), N_V);
+    }
     return valid;
 }
 distance_t UndirectedGraph::distance(vertex_index_t u, vertex_index_t v) const {
@@ -285,13 +531,14 @@ distance_t UndirectedGraph::distance(vertex_index_t u, vertex_index_t v) const {
                          "v (in an edge) is invalid.(%d)", v);
     THROW_LOGIC_ERROR_IF(v < 0 || v >= N_V,
                          "v (in an edge) is out of range.(%d)", v);
-    return dist_mat_[N_V * u + v];
+    return dist_mat_.get(u, v);
 }
 distance_t UndirectedGraph::distance(const Position& p1, const Position& p2,
                                      vertex_index_t* towards1,
                                      vertex_index_t* from2) const {
-    THROW_LOGIC_ERROR_IF(
-        !is_position_valid(p1) || !is_position_valid(p2),
+    THROW_INVARIANT_ERROR_IF(
+        check_position(p1) != CheckCode::OK ||
+            check_position(p2) != CheckCode::OK,
         "Positions are invalid (in position distance calculation)");
     if (distance(p1.u, p2.u) == INVALID_DISTANCE) {
         THROW_LOGIC_ERROR_IF(distance(p1.u, p2.v) != INVALID_DISTANCE ||
@@ -387,8 +634,8 @@ distance_t UndirectedGraph::distance(const Position& p1, const Position& p2,
     auto idx = std::distance(ds.begin(), it);
     auto via_adj = [&](vertex_index_t vertex_at, const Position& dest) {
         auto it_ =
-            std::min_element(organized_edges_[vertex_at].begin(),
-                             organized_edges_[vertex_at].end(),
+            std::min_element(adj_.begin() + adj_offsets_[vertex_at],
+                             adj_.begin() + adj_offsets_[vertex_at + 1],
                              [&](std::pair<distance_t, vertex_index_t> a,
                                  std::pair<distance_t, vertex_index_t> b) {
                                  return a.first + distance(a.second, dest) <
@@ -482,21 +729,27 @@ vertex_index_t UndirectedGraph::next_vertex(const Position& current,
                                             vertex_index_t target) const {
     THROW_LOGIC_ERROR_IF(!is_distance_info_computed(),
                          "Distances are not computed.");
-    THROW_LOGIC_ERROR_IF(!is_position_valid(current),
-                         "Current position is invalid.");
+    THROW_INVARIANT_ERROR_IF(check_position(current) != CheckCode::OK,
+                             "Current position is invalid.");
     THROW_LOGIC_ERROR_IF(target == INVALID_VERTEX_ID,
                          "Target vertex is invalid.");
     THROW_LOGIC_ERROR_IF(target < 0 || target >= N_V,
                          "Target vertex is out of range.(%d)", target);
+    if (current.u == current.v && !first_moves_.empty()) {
+        const uint8_t slot =
+            first_moves_[static_cast<size_t>(N_V) * current.u + target];
+        if (slot == NO_FIRST_MOVE) {
+            return INVALID_VERTEX_ID;
+        }
+        return adj_[adj_offsets_[current.u] + slot].second;
+    }
     vertex_index_t towards1;
     distance(current, Position(target), &towards1, nullptr);
     return towards1;
 }
 bool UndirectedGraph::is_directly_movable_to(const Position& current,
                                              vertex_index_t target) const {
-    THROW_LOGIC_ERROR_IF(!is_position_valid(current),
-                         "Current position is invalid.");
-    THROW_LOGIC_ERROR_IF(!is_position_valid(current),
+    THROW_LOGIC_ERROR_IF(check_position(current) != CheckCode::OK,
                          "Current position is invalid.");
     THROW_LOGIC_ERROR_IF(target == INVALID_VERTEX_ID,
                          "Target vertex is invalid.");
@@ -506,13 +759,9 @@ bool UndirectedGraph::is_directly_movable_to(const Position& current,
         if (current.u == target) {
             return true;
         }
-        const auto& adj = organized_edges_[current.u];
-        using vtype =
-            std::remove_const_t<std::remove_reference_t<decltype(adj)>>;
-        return std::find_if(adj.begin(), adj.end(),
-                            [&](const vtype::value_type& p) {
-                                return p.second == target;
-                            }) != adj.end();
+        return std::any_of(adj_.begin() + adj_offsets_[current.u],
+                           adj_.begin() + adj_offsets_[current.u + 1],
+                           [&](const auto& p) { return p.second == target; });
     }
     return current.u == target || current.v == target;
 }
@@ -529,10 +778,7 @@ size_t UndirectedGraph::vertex_num() const {
     return N_V;
 }
 size_t UndirectedGraph::edge_num() const {
-    size_t ret = 0;
-    for (const auto& v : organized_edges_) {
-        ret += v.size();
-    }
+    const size_t ret = adj_.size();
     THROW_LOGIC_ERROR_IF(ret % 2 != 0, "Non-symmetric edges");
     return ret / 2;
 }
@@ -559,33 +805,29 @@ void to_json(json_ref j, const UndirectedGraph& ug) {
 Position::Position() = default;
 Position::Position(vertex_index_t idx) : u(idx), v(idx), distance_from_u(0) {
 }
+CheckCode Position::check() const {
+    RETURN_CHECK_CODE_IF(u == INVALID_VERTEX_ID, POSITION_U_IS_INVALID);
+    RETURN_CHECK_CODE_IF(u < 0, POSITION_U_IS_NEGATIVE);
+    RETURN_CHECK_CODE_IF(v == INVALID_VERTEX_ID, POSITION_V_IS_INVALID);
+    RETURN_CHECK_CODE_IF(v < 0, POSITION_V_IS_NEGATIVE);
+    RETURN_CHECK_CODE_IF(distance_from_u == INVALID_VERTEX_ID,
+                         POSITION_DISTANCE_IS_INVALID);
+    RETURN_CHECK_CODE_IF(distance_from_u < 0, POSITION_DISTANCE_IS_NEGATIVE);
+    RETURN_CHECK_CODE_IF(u == v && distance_from_u > 0,
+                         POSITION_EXACT_VERTEX_HAS_DISTANCE);
+    RETURN_CHECK_CODE_IF(u != v && distance_from_u == 0,
+                         POSITION_IS_NOT_CANONICAL);
+    return CheckCode::OK;
+}
 bool Position::is_broken(std::string* msg) const {
-    bool not_broken = true;
-    if (msg)
-        msg->clear();
-    VALIDITY_CHECK_WITH_MSG(u == INVALID_VERTEX_ID, not_broken, msg,
-                            "u is INVALID");
-    VALIDITY_CHECK_WITH_MSG(u < 0, not_broken, msg, "u is negative");
-    VALIDITY_CHECK_WITH_MSG(v == INVALID_VERTEX_ID, not_broken, msg,
-                            "v is INVALID");
-    VALIDITY_CHECK_WITH_MSG(v < 0, not_broken, msg, "v is negative");
-    VALIDITY_CHECK_WITH_MSG(distance_from_u == INVALID_VERTEX_ID, not_broken,
-                            msg, "distance is INVALID");
-    VALIDITY_CHECK_WITH_MSG(distance_from_u < 0, not_broken, msg,
-                            "distance is negative");
-    VALIDITY_CHECK_WITH_MSG(u == v && distance_from_u > 0, not_broken, msg,
-                            "u == v but the distance is positive (>0)");
-    VALIDITY_CHECK_WITH_MSG(
-        u != v && distance_from_u == 0, not_broken, msg,
-        "u != v but the distance is zero (for canonical expression)");
-    return !not_broken;
+    return !report_check(check(), msg);
 }
 bool Position::is_exact_vertex() const {
-    std::string msg;
-    THROW_LOGIC_ERROR_IF(
-        is_broken(&msg),
-        "This position data is broken for the following reason(s):%s",
-        msg.c_str());
+    const CheckCode code = check();
+    THROW_LOGIC_ERROR_IF(code != CheckCode::OK,
+                         "This position data is broken for the following "
+                         "reason(s):%s",
+                         check_code_to_str(code));
     return u == v;
 }
 void to_json(json_ref j, const Position& p) {
@@ -1,11 +1,13 @@
 #ifndef HEADER_2HC2022_GRAPH
 #define HEADER_2HC2022_GRAPH 
+#include <cstdint>
 #include <map>
 #include <string>
 #include <tuple>
 #include <utility>
 #include <vector>
 #include "defines.hpp"
+#include "distance_matrix.hpp"
 #include "error_check.hpp"
 #include "json_fwd.hpp"
 class Edge {
@@ -43,19 +45,38 @@ class UndirectedGraph {
     using edge_seq_t_ = std::vector<Edge>;
     int N_V = INVALID_COUNT;
     int N_E = INVALID_COUNT;
-    std::vector<distance_t> dist_mat_;
+    DistanceMatrix dist_mat_;
+    // first_moves_[N_V * u + t]: adjacency slot of u (adj_offsets_[u] + slot)
+    // that starts a shortest path to t, the earliest one among ties; left
+    // empty when some vertex has too many neighbors for a byte.
+    std::vector<uint8_t> first_moves_;
+    static constexpr uint8_t NO_FIRST_MOVE = 255;
     edge_seq_t_ edges_;
-    std::vector<std::vector<std::pair<distance_t, vertex_index_t>>>
-        organized_edges_;
+    // Adjacency in CSR form: the neighbors of v are
+    // adj_[adj_offsets_[v]] ... adj_[adj_offsets_[v + 1] - 1].
+    std::vector<int> adj_offsets_;
+    std::vector<std::pair<distance_t, vertex_index_t>> adj_;
     bool graph_loaded_ = false;
     bool distances_computed_ = false;
+    uint8_t first_move_via_(vertex_index_t origin, vertex_index_t u, int i,
+                            const uint8_t* first) const;
+    // Single-source searches; first, when given, receives the first moves.
+    void bucket_dijkstra_(vertex_index_t origin, distance_t* dist,
+                          std::vector<std::vector<vertex_index_t>>& buckets,
+                          uint8_t* first) const;
+    void radix_dijkstra_(vertex_index_t origin, distance_t* dist,
+                         uint8_t* first) const;
     std::map<vertex_index_t, std::pair<double, double>> coords_;
  public:
     std::pair<double, double> get_coordinates(vertex_index_t vid) const;
     void read_graph(std::istream& is);
     bool is_graph_loaded() const;
-    void compute_distance_info();
+    // thread_num == 0 uses all hardware threads.
+    void compute_distance_info(unsigned thread_num = 0);
     bool is_distance_info_computed() const;
+    // Unchecked lookups for code that reads many distances.
+    const DistanceMatrix& distance_matrix() const;
+    CheckCode check_position(const Position& p) const;
     bool is_position_valid(const Position& p, std::string* msg = nullptr) const;
     distance_t distance(vertex_index_t u, vertex_index_t v) const;
     distance_t distance(const Position& p1, const Position& p2,
@@ -72,10 +93,9 @@ class UndirectedGraph {
     size_t edge_num() const;
     bool vertex_exists(vertex_index_t vid) const;
     template <class Fn> void for_each_edge(const Fn& f) const {
-        for (int i = 0; i < organized_edges_.size(); i++) {
-            const auto& v = organized_edges_[i];
-            for (int j = 0; j < v.size(); j++) {
-                auto [d, to] = v[j];
+        for (int i = 0; i < N_V; i++) {
+            for (int j = adj_offsets_[i]; j < adj_offsets_[i + 1]; j++) {
+                auto [d, to] = adj_[j];
                 THROW_LOGIC_ERROR_IF(i == to,
                                      "The graph contains self loops(%d)", i);
                 if (i < to) {
@@ -92,6 +112,7 @@ struct Position {
     distance_t distance_from_u = INVALID_DISTANCE;
     Position();
     explicit Position(vertex_index_t idx);
+    CheckCode check() const;
     bool is_broken(std::string* msg = nullptr) const;
     bool is_exact_vertex() const;
     friend void to_json(json_ref j, const Position& a);
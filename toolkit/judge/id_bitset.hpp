@@ -0,0 +1,99 @@
+#ifndef HEADER_2HC2022_ID_BITSET
+#define HEADER_2HC2022_ID_BITSET 
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+#include "error_check.hpp"
+// A set of dense ids (jobs, workers, ...) stored as bits. Iteration is in
+// ascending id order and the number of members is kept up to date.
+class IdBitset {
+    std::vector<uint64_t> words_;
+    int size_ = 0;
+    int count_ = 0;
+    static int word_num_(int n) {
+        return (n + 63) >> 6;
+    }
+    void recount_() {
+        count_ = 0;
+        for (auto w : words_) {
+            count_ += __builtin_popcountll(w);
+        }
+    }
+ public:
+    IdBitset() = default;
+    explicit IdBitset(int n) {
+        assign(n);
+    }
+    void assign(int n) {
+        words_.assign(word_num_(n), 0);
+        size_ = n;
+        count_ = 0;
+    }
+    void resize(int n) {
+        words_.resize(word_num_(n), 0);
+        if (n < size_ && (n & 63) != 0) {
+            words_.back() &= (uint64_t(1) << (n & 63)) - 1;
+        }
+        size_ = n;
+        recount_();
+    }
+    void clear() {
+        std::fill(words_.begin(), words_.end(), 0);
+        count_ = 0;
+    }
+    int size() const {
+        return size_;
+    }
+    int count() const {
+        return count_;
+    }
+    bool in_range(int id) const {
+        return 0 <= id && id < size_;
+    }
+    bool test(int id) const {
+        return (words_[id >> 6] >> (id & 63)) & 1;
+    }
+    // Returns true if the id was not a member yet.
+    bool set(int id) {
+        uint64_t& w = words_[id >> 6];
+        const uint64_t bit = uint64_t(1) << (id & 63);
+        if (w & bit) {
+            return false;
+        }
+        w |= bit;
+        count_++;
+        return true;
+    }
+    void reset(int id) {
+        uint64_t& w = words_[id >> 6];
+        const uint64_t bit = uint64_t(1) << (id & 63);
+        if (w & bit) {
+            w &= ~bit;
+            count_--;
+        }
+    }
+    template <class Fn> void for_each(const Fn& f) const {
+        for (int i = 0; i < static_cast<int>(words_.size()); i++) {
+            for (uint64_t w = words_[i]; w; w &= w - 1) {
+                f((i << 6) | __builtin_ctzll(w));
+            }
+        }
+    }
+    std::vector<int> ids() const {
+        std::vector<int> ret;
+        ret.reserve(count_);
+        for_each([&](int id) { ret.push_back(id); });
+        return ret;
+    }
+    template <class Writer> void snapshot(Writer& w) const {
+        w.write_sequence(words_);
+    }
+    template <class Reader> void restore(Reader& r) {
+        r.read_sequence(words_);
+        THROW_RUNTIME_ERROR_IF(
+            static_cast<int>(words_.size()) != word_num_(size_),
+            "Bitset size of the snapshot does not match.");
+        recount_();
+    }
+};
+#endif
@@ -5,6 +5,7 @@
 #include <regex>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <utility>
 #include "defines.hpp"
 #include "error_check.hpp"
@@ -50,9 +51,9 @@ class ValueWriter {
 template <class T> struct TaggedValue {
     T& ref_;
     ValueGroup grp;
-    std::string comment;
+    DiagnosticContext comment;
     WrongAnswerType wa_type = WrongAnswerType::INVALID;
-    TaggedValue(ValueGroup g_, T& r_, std::string comment_,
+    TaggedValue(ValueGroup g_, T& r_, const DiagnosticContext& comment_,
                 WrongAnswerType wa_type_ = WrongAnswerType::INVALID)
         : ref_(r_), grp(g_), comment(comment_), wa_type(wa_type_) {
     }
@@ -60,7 +61,7 @@ template <class T> struct TaggedValue {
         if constexpr (std::is_const_v<T>) {
             THROW_LOGIC_ERROR_IF(true,
                                  "Do not read data into const TaggedValue:%s",
-                                 vr.comment.c_str());
+                                 vr.comment.str().c_str());
         } else {
             switch (vr.grp) {
             case ValueGroup::NONE: {
@@ -79,7 +80,7 @@ template <class T> struct TaggedValue {
                     vr.wa_type,
                     !std::regex_match(s, std::regex(R"(0|[1-9]\d*)")),
                     "Invalid string for ValueGroup SEED (%s) (Regex:%s) :%s",
-                    s.c_str(), R"(0|[1-9]\d*)", vr.comment.c_str());
+                    s.c_str(), R"(0|[1-9]\d*)", vr.comment.str().c_str());
                 std::stringstream ss;
                 ss << s;
                 ss >> vr.ref_;
@@ -93,7 +94,7 @@ template <class T> struct TaggedValue {
                         vr.wa_type, vr.ref_ < 0,
                         "The specified value group is NON_NEGATIVE_COUNT "
                         "but the actual value is negative.(%d):%s",
-                        (int)vr.ref_, vr.comment.c_str());
+                        (int)vr.ref_, vr.comment.str().c_str());
                 }
                 break;
             }
@@ -102,14 +103,13 @@ template <class T> struct TaggedValue {
                 reader.is >> vr.ref_;
                 if constexpr (std::is_arithmetic_v<T> ||
                               std::is_same_v<remove_all_t<T>, float_score_t>) {
-                    std::stringstream ss;
-                    ss << vr.ref_;
                     WA_OR_RE_IF(
                         vr.wa_type, vr.ref_ <= 0,
                         "The specified value group is "
                         "POSITIVE_COUNT/POSITIVE_DURATION "
                         "but the actual value is zero or negative.(%s):%s",
-                        ss.str().c_str(), vr.comment.c_str());
+                        stream_to_string(vr.ref_).c_str(),
+                        vr.comment.str().c_str());
                 }
                 break;
             }
@@ -136,7 +136,7 @@ template <class T> struct TaggedValue {
                         true,
                         "Non-arithmetic values cannot be used for "
                         "TYPEID/TIME/WEATHER_VALUE/INDEX:%s",
-                        vr.comment.c_str());
+                        vr.comment.str().c_str());
                 }
                 break;
             }
@@ -153,21 +153,21 @@ template <class T> struct TaggedValue {
                                     "The value group specified is FLAG "
                                     "but the actual value is "
                                     "neither 0 nor 1.(%d):%s",
-                                    f, vr.comment.c_str());
+                                    f, vr.comment.str().c_str());
                     }
                 } else {
                     THROW_LOGIC_ERROR_IF(true, "FLAG values must be boolean:%s",
-                                         vr.comment.c_str());
+                                         vr.comment.str().c_str());
                 }
                 break;
             }
             default:
                 THROW_LOGIC_ERROR_IF(true, "Unsupported value group (in):%s",
-                                     vr.comment.c_str());
+                                     vr.comment.str().c_str());
             }
             WA_OR_RE_IF(vr.wa_type, !reader,
                         "Failed to read a tagged value.:%s",
-                        vr.comment.c_str());
+                        vr.comment.str().c_str());
             return reader;
         }
     }
@@ -189,7 +189,7 @@ template <class T> struct TaggedValue {
                     vr.ref_ < 0,
                     "The specified value group is SEED "
                     "but the actual value is negative.(%d):%s",
-                    (int)vr.ref_, vr.comment.c_str());
+                    (int)vr.ref_, vr.comment.str().c_str());
             }
             writer.os << vr.ref_;
             break;
@@ -201,7 +201,7 @@ template <class T> struct TaggedValue {
                     vr.ref_ < 0,
                     "The specified value group is NON_NEGATIVE_COUNT "
                     "but the actual value is negative.(%d):%s",
-                    (int)vr.ref_, vr.comment.c_str());
+                    (int)vr.ref_, vr.comment.str().c_str());
             }
             writer.os << vr.ref_;
             break;
@@ -210,14 +210,13 @@ template <class T> struct TaggedValue {
         case ValueGroup::POSITIVE_COUNT: {
             if constexpr (std::is_arithmetic_v<T> ||
                           std::is_same_v<remove_all_t<T>, float_score_t>) {
-                std::stringstream ss;
-                ss << vr.ref_;
                 THROW_RUNTIME_ERROR_IF(
                     vr.ref_ <= 0,
                     "The specified value group is "
                     "POSITIVE_COUNT/POSITIVE_DURATION "
                     "but the actual value is zero or negative.(%s):%s",
-                    ss.str().c_str(), vr.comment.c_str());
+                    stream_to_string(vr.ref_).c_str(),
+                    vr.comment.str().c_str());
             }
             writer.os << vr.ref_;
             break;
@@ -243,7 +242,7 @@ template <class T> struct TaggedValue {
                 THROW_LOGIC_ERROR_IF(true,
                                      "Non-arithmetic values cannot be used for "
                                      "TYPEID/TIME/WEATHER_VALUE/INDEX:%s",
-                                     vr.comment.c_str());
+                                     vr.comment.str().c_str());
             }
             break;
         }
@@ -259,12 +258,12 @@ template <class T> struct TaggedValue {
                                          "The value group specified is FLAG "
                                          "but the actual value is "
                                          "neither true nor false.:%s",
-                                         vr.comment.c_str());
+                                         vr.comment.str().c_str());
                 }
                 writer.os << f;
             } else {
                 THROW_LOGIC_ERROR_IF(true, "FLAG values must be boolean:%s",
-                                     vr.comment.c_str());
+                                     vr.comment.str().c_str());
             }
             break;
         }
@@ -274,7 +273,7 @@ template <class T> struct TaggedValue {
         }
         default:
             THROW_LOGIC_ERROR_IF(true, "Unsupported value group (out):%s",
-                                 vr.comment.c_str());
+                                 vr.comment.str().c_str());
         }
         return writer;
     }
@@ -282,36 +281,39 @@ template <class T> struct TaggedValue {
 #define TAG(vg,...) TAGWA(WrongAnswerType::INVALID, vg, __VA_ARGS__)
 #ifndef ONLINE_JUDGE
 #define TAGWA(wa_type,vg,...) \
-    (TAG_(vg, __VA_ARGS__, "\n" + BASENAME_LINE_STR_ + #__VA_ARGS__, wa_type))
+    (TAG_(vg, __VA_ARGS__, DiagnosticContext(SOURCE_LOCATION_, #__VA_ARGS__), \
+          wa_type))
 #else
-#define TAGWA(wa_type,vg,...) (TAG_(vg, __VA_ARGS__, "", wa_type))
+#define TAGWA(wa_type,vg,...) \
+    (TAG_(vg, __VA_ARGS__, DiagnosticContext(), wa_type))
 #endif
 template <class T>
-TaggedValue<T> TAG_(ValueGroup vg, T& var, std::string comment,
+TaggedValue<T> TAG_(ValueGroup vg, T& var, const DiagnosticContext& comment,
                     WrongAnswerType wa_type) {
     return TaggedValue(vg, var, comment, wa_type);
 }
 template <class T>
-TaggedValue<const T> TAG_(ValueGroup vg, const T& var, std::string comment,
+TaggedValue<const T> TAG_(ValueGroup vg, const T& var,
+                          const DiagnosticContext& comment,
                           WrongAnswerType wa_type) {
     return TaggedValue(vg, var, comment, wa_type);
 }
 #define VA_(...) #__VA_ARGS__
 #ifndef ONLINE_JUDGE
 #define get_single_line_stream(...) \
-    (get_single_line_stream_(__VA_ARGS__, "\n\t%s %s", BASENAME_LINE_C_STR_, \
-                             VA_(__VA_ARGS__)))
+    (get_single_line_stream_(__VA_ARGS__, \
+                             DiagnosticContext(SOURCE_LOCATION_, \
+                                               VA_(__VA_ARGS__))))
 #else
 #define get_single_line_stream(...) (get_single_line_stream_(__VA_ARGS__))
 #endif
-template <class... Args>
-inline ValueReader get_single_line_stream_(const ValueReader& r,
-                                           Args&&... args) {
+inline ValueReader
+get_single_line_stream_(const ValueReader& r,
+                        const DiagnosticContext& ctx = DiagnosticContext()) {
     std::string line;
     std::getline(r.is, line);
 #ifndef ONLINE_JUDGE
-    THROW_RUNTIME_ERROR_IF(!r, "Failed to read a line:%s",
-                           format_str(std::forward<Args>(args)...).c_str());
+    THROW_RUNTIME_ERROR_IF(!r, "Failed to read a line:%s", ctx.str().c_str());
 #else
     THROW_RUNTIME_ERROR_IF(!r, "");
 #endif
@@ -328,7 +330,9 @@ throw_if_nontrivial_chars_left(ValueReader& r,
         if (!r)
             break;
         WA_OR_RE_IF(
-            wat, std::string(&c, 1) != std::string(CONTESTANT_VALUE_DELIMITER),
+            wat,
+            std::string_view(&c, 1) !=
+                std::string_view(CONTESTANT_VALUE_DELIMITER),
             "Some nontrivial characters are still left");
     }
 }
@@ -451,14 +455,4 @@ class null_stream : public std::ostream {
  private:
     debug_null_buffer_DO_NOT_USE_ m_sb;
 };
-class LogInfoSwitcher {
- protected:
-    mutable bool log_mutable_only_ = false;
-    mutable discrete_time_t switched_time_ = INVALID_TIME;
- public:
-    virtual void log_mutable_info_only(discrete_time_t crt0b, bool e) const {
-        log_mutable_only_ = e;
-        switched_time_ = crt0b;
-    }
-};
 #endif
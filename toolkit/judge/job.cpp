@@ -3,37 +3,30 @@
 #include <utility>
 #include "error_check.hpp"
 #include "io.hpp"
+#include "json_log.hpp"
 #include "lib/json.hpp"
 #include "logger.hpp"
+#include "snapshot.hpp"
 #include "worker.hpp"
+CheckCode JobInfo::check() const {
+    RETURN_CHECK_CODE_IF(type < 0 || type == INVALID_JOB_TYPE,
+                         JOB_TYPE_IS_INVALID);
+    RETURN_CHECK_CODE_IF(n_task == INVALID_COUNT, JOB_TASK_NUM_IS_INVALID);
+    RETURN_CHECK_CODE_IF(n_task < 1, JOB_TASK_NUM_IS_NOT_POSITIVE);
+    RETURN_CHECK_CODE_IF(gain_function_data.empty(), JOB_HAS_NO_GAIN_FUNCTION);
+    RETURN_CHECK_CODE_IF(position == INVALID_VERTEX_ID,
+                         JOB_POSITION_IS_INVALID);
+    RETURN_CHECK_CODE_IF(position < 0, JOB_POSITION_IS_NEGATIVE);
+    RETURN_CHECK_CODE_IF(penalty_coeff == INVALID_REAL,
+                         JOB_PENALTY_COEFF_IS_INVALID);
+    RETURN_CHECK_CODE_IF(penalty_coeff < 0.0 || penalty_coeff > 1.0,
+                         JOB_PENALTY_COEFF_IS_OUT_OF_RANGE);
+    return CheckCode::OK;
+}
 bool JobInfo::is_valid(std::string* msg) const {
-    bool invalid = false;
-    if (msg != nullptr) {
-        *msg = "";
-    }
-#define TRUE_IF_INVALID(m,...) \
-    do { \
-        if (__VA_ARGS__) { \
-            if (msg != nullptr) { \
-                *msg += m "\n"; \
-            } \
-            invalid = true; \
-        } \
-    } while (0)
-    TRUE_IF_INVALID("Job type is INVALID or negative(internal)",
-                    type < 0 || type == INVALID_JOB_TYPE);
-    TRUE_IF_INVALID("Task num is INVALID", n_task == INVALID_COUNT);
-    TRUE_IF_INVALID("Task num is 0 or negative", n_task < 1);
-    TRUE_IF_INVALID("No gain function data.", gain_function_data.empty());
-    TRUE_IF_INVALID("Position index is INVALID", position == INVALID_VERTEX_ID);
-    TRUE_IF_INVALID("Position index is negative", position < 0);
-    TRUE_IF_INVALID("Penalty coefficient is INVALID",
-                    penalty_coeff == INVALID_REAL);
-    TRUE_IF_INVALID("Penalty coefficient is out of range",
-                    penalty_coeff < 0.0 || penalty_coeff > 1.0);
-    return !invalid;
-}
-float_score_t JobInfo::gain(discrete_time_t t) const {
+    return report_check(check(), msg);
+}
+ExactScore JobInfo::gain(discrete_time_t t) const {
     return piecewise_linear_function(gain_function_data, t);
 }
 void JobInfo::read_from_stream(WorldType wt, std::istream& is__) {
@@ -92,13 +85,11 @@ void JobInfo::read_from_stream(WorldType wt, std::istream& is__) {
                 dependency.insert(dep_id);
             });
     }
-    {
-        std::string msg;
-        THROW_RUNTIME_ERROR_IF(!is_valid(&msg),
-                               "(after loading job info from stream) Job info "
-                               "is invalid for the following reason(s):%s",
-                               msg.c_str());
-    }
+    const CheckCode code = check();
+    THROW_RUNTIME_ERROR_IF(code != CheckCode::OK,
+                           "(after loading job info from stream) Job info "
+                           "is invalid for the following reason(s):%s",
+                           check_code_to_str(code));
 }
 void to_json(json_ref j, const JobInfo& ji) {
     j = json{
@@ -119,17 +110,30 @@ std::ostream& operator<<(std::ostream& os, const JobInfo& j) {
     os << js;
     return os;
 }
+CheckCode JobState::check() const {
+    RETURN_CHECK_CODE_IF(task_cumul() == INVALID_COUNT || task_cumul() < 0,
+                         JOB_TASK_CUMUL_IS_INVALID);
+    RETURN_CHECK_CODE_IF(pending_task_done_ < 0, JOB_PENDING_TASK_IS_NEGATIVE);
+    return CheckCode::OK;
+}
 bool JobState::is_valid(std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    VALIDITY_CHECK_WITH_MSG(
-        task_cumul() == INVALID_COUNT || task_cumul() < 0, valid, msg,
-        "Cumulative task amount is invalid (including negative)");
-    VALIDITY_CHECK_WITH_MSG(pending_task_done_ < 0, valid, msg,
-                            "Temporary cumulative task amount(to be recorded "
-                            "at the next finalization) is negative");
-    return valid;
+    return report_check(check(), msg);
+}
+void JobState::snapshot(SnapshotWriter& w) const {
+    w.write(task_cumul_);
+    w.write(pending_task_done_);
+}
+void JobState::restore(SnapshotReader& r) {
+    r.read(task_cumul_);
+    r.read(pending_task_done_);
+}
+void JobState::write_turn_log(JsonLogWriter& w) const {
+    w.begin_object();
+    w.key("pending_task_done");
+    w.value(pending_task_done_);
+    w.key("task_cumul");
+    w.value(task_cumul());
+    w.end_object();
 }
 void to_json(json_ref j, const JobState& js) {
     j = json{
@@ -140,6 +144,9 @@ void to_json(json_ref j, const JobState& js) {
 int JobState::task_cumul() const {
     return task_cumul_;
 }
+int JobState::pending_task_done() const {
+    return pending_task_done_;
+}
 std::ostream& operator<<(std::ostream& os, const JobState& js) {
     json j = js;
     os << j;
@@ -158,27 +165,15 @@ void JobState::finalize_task_done() {
     task_cumul_ += pending_task_done_;
     pending_task_done_ = 0;
 }
+CheckCode Job::check() const {
+    RETURN_CHECK_CODE_IF(id() == INVALID_JOB_ID, JOB_ID_IS_INVALID);
+    RETURN_CHECK_CODE_IF(id() < 0, JOB_ID_IS_NEGATIVE);
+    RETURN_IF_CHECK_FAILED(info().check());
+    RETURN_IF_CHECK_FAILED(state.check());
+    return CheckCode::OK;
+}
 bool Job::is_valid(std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    VALIDITY_CHECK_WITH_MSG(id() == INVALID_JOB_ID, valid, msg,
-                            "Job ID is invalid.");
-    VALIDITY_CHECK_WITH_MSG(id() < 0, valid, msg, "Job ID is negative.");
-    {
-        std::string imsg;
-        VALIDITY_CHECK_WITH_MSG(
-            !info.is_valid(&imsg), valid, msg,
-            "Job info is invalid for the following reason(s):%s", imsg.c_str());
-    }
-    {
-        std::string smsg;
-        VALIDITY_CHECK_WITH_MSG(
-            !state.is_valid(&smsg), valid, msg,
-            "Job State is invalid for the following reason(s):%s",
-            smsg.c_str());
-    }
-    return valid;
+    return report_check(check(), msg);
 }
 job_id_t Job::id() const {
     return id_;
@@ -188,14 +183,20 @@ std::ostream& operator<<(std::ostream& os, const Job& j) {
     os << js;
     return os;
 }
+const JobInfo& Job::info() const {
+    THROW_LOGIC_ERROR_IF(!info_, "Job info is not loaded yet.");
+    return *info_;
+}
 void Job::read_job_info(WorldType wt, std::istream& is) {
-    info.read_from_stream(wt, is);
+    auto info = std::make_shared<JobInfo>();
+    info->read_from_stream(wt, is);
+    info_ = std::move(info);
 }
 void Job::initialize_state() {
     state.initialize();
 }
 void Job::task_done_NOT_FINALIZED(int amount) {
-    int ntask = info.n_task;
+    int ntask = info().n_task;
     THROW_LOGIC_ERROR_IF(state.task_cumul() + amount > ntask,
                          "Total task amount done exceeds n_task");
     state.task_done_NOT_FINALIZED(amount);
@@ -205,19 +206,23 @@ void Job::finalize_task_done() {
 }
 bool Job::completed() const {
     THROW_LOGIC_ERROR_IF(
-        state.task_cumul() > info.n_task,
+        state.task_cumul() > info().n_task,
         "Something is wrong; cumulative task amount exceeds n_task");
-    return state.task_cumul() == info.n_task;
+    return state.task_cumul() == info().n_task;
 }
 int Job::task_rest() const {
-    return info.n_task - state.task_cumul();
+    return info().n_task - state.task_cumul();
 }
 void to_json(json_ref j, const Job& job) {
-    if (job.log_mutable_only_) {
-        j = json{{"id", job.id()}, {"state", job.state}};
-    } else {
-        j = json{{"id", job.id()}, {"info", job.info}, {"state", job.state}};
-    }
+    j = json{{"id", job.id()}, {"info", job.info()}, {"state", job.state}};
+}
+void Job::write_turn_log(JsonLogWriter& w) const {
+    w.begin_object();
+    w.key("id");
+    w.value(id());
+    w.key("state");
+    state.write_turn_log(w);
+    w.end_object();
 }
 void TaskLimitInfo::read_from_stream(std::istream& is) {
     ValueReader r(is);
@@ -237,13 +242,16 @@ void TaskLimitInfo::read_from_stream(std::istream& is) {
     }
     INFO("Task limit info loaded successfully.");
 }
-int TaskLimitInfo::task_limit(int n_max, double weather_dep,
-                              weather_value_t weather) const {
+double TaskLimitInfo::task_limit_factor(double weather_dep,
+                                        weather_value_t weather) const {
     if (1.0 - weather_dep == 0.0 && weather_limit_const_.at(weather) == 0) {
-        return n_max;
+        return 1.0;
     }
-    return n_max *
-           std::pow(1.0 - weather_dep, weather_limit_const_.at(weather));
+    return std::pow(1.0 - weather_dep, weather_limit_const_.at(weather));
+}
+int TaskLimitInfo::task_limit(int n_max, double weather_dep,
+                              weather_value_t weather) const {
+    return n_max * task_limit_factor(weather_dep, weather);
 }
 void to_json(json_ref j, const TaskLimitInfo& tl) {
     j = json{{"weather_limit_coeff", tl.weather_limit_const_}};
@@ -1,6 +1,7 @@
 #ifndef HEADER_2HC2022_JOB
 #define HEADER_2HC2022_JOB 
 #include <algorithm>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
@@ -11,6 +12,9 @@
 #include "piecewise_function.hpp"
 #include "weather.hpp"
 class JobManager;
+class SnapshotReader;
+class JsonLogWriter;
+class SnapshotWriter;
 struct JobInfo {
     job_type_t type = INVALID_JOB_TYPE;
     int n_task = INVALID_COUNT;
@@ -21,8 +25,9 @@ struct JobInfo {
     std::unordered_set<job_id_t> dependency;
     job_id_t id = INVALID_JOB_ID;
     double weather_dependency = INVALID_REAL;
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
-    float_score_t gain(discrete_time_t t) const;
+    ExactScore gain(discrete_time_t t) const;
     void read_from_stream(WorldType wt, std::istream& is);
     friend void to_json(json_ref j, const JobInfo& ji);
     friend std::ostream& operator<<(std::ostream& os, const JobInfo& j);
@@ -32,20 +37,28 @@ class JobState {
     int pending_task_done_ = 0;
  public:
     int task_cumul() const;
+    int pending_task_done() const;
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
     friend void to_json(json_ref j, const JobState& js);
     friend std::ostream& operator<<(std::ostream& os, const JobState& j);
     void initialize();
     void task_done_NOT_FINALIZED(int task_num);
     void finalize_task_done();
+    void snapshot(SnapshotWriter& w) const;
+    void restore(SnapshotReader& r);
+    void write_turn_log(JsonLogWriter& w) const;
 };
-class Job : public LogInfoSwitcher {
+class Job {
     job_id_t id_ = INVALID_JOB_ID;
+    std::shared_ptr<const JobInfo> info_;
  public:
     job_id_t id() const;
-    JobInfo info;
+    const JobInfo& info() const;
     JobState state;
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
+    void write_turn_log(JsonLogWriter& w) const;
     friend void to_json(json_ref j, const Job& jb);
     friend std::ostream& operator<<(std::ostream& os, const Job& j);
     void read_job_info(WorldType wt, std::istream& is);
@@ -60,6 +73,8 @@ class TaskLimitInfo {
     std::vector<int> weather_limit_const_;
  public:
     void read_from_stream(std::istream& is);
+    double task_limit_factor(double weather_dep,
+                             weather_value_t weather) const;
     int task_limit(int n_max, double weather_dep,
                    weather_value_t weather) const;
     size_t limit_constant_num() const;
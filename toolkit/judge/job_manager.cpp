@@ -3,10 +3,13 @@
 #include <string>
 #include <utility>
 #include <vector>
+#include "binary_log.hpp"
 #include "error_check.hpp"
 #include "io.hpp"
+#include "json_log.hpp"
 #include "lib/json.hpp"
 #include "logger.hpp"
+#include "snapshot.hpp"
 #include "worker.hpp"
 void JobManager::set_world_type(WorldType wt) {
     world_type_ = wt;
@@ -24,85 +27,129 @@ void JobManager::accept_jobs(std::istream& is_) {
     read_vars(ss, TAG(ValueGroup::COUNT, n));
     THROW_WA_IF(WrongAnswerType::SELECTED_NUM_IS_NEGATIVE, n < 0,
                 "The number of jobs accepted is negative.");
-    std::unordered_set<job_id_t> ids;
+    IdBitset ids(job_num());
     read_n_vars_exact<job_id_t>(
         ss, n, ValueGroup::INDEX,
         [&](job_id_t id) {
             THROW_WA_IF(WrongAnswerType::SELECTED_JOB_DOES_NOT_EXIST,
                         !job_exists(id), "one of selected jobs does not exist");
-            THROW_WA_IF(WrongAnswerType::DUPS_IN_SELECTED_JOBS,
-                        ids.find(id) != ids.end(),
+            THROW_WA_IF(WrongAnswerType::DUPS_IN_SELECTED_JOBS, !ids.set(id),
                         "duplicate in selected jobs");
-            ids.emplace(id);
         },
         WrongAnswerType::SELECTED_NUM_NEQ_ACTUAL_SELECTED_ID_NUM);
     accept_jobs_(ids);
     INFO("The selected jobs have been accepted successfully.");
 }
+void JobManager::accept_jobs(const std::vector<job_id_t>& ids_) {
+    IdBitset ids(job_num());
+    for (auto id : ids_) {
+        THROW_WA_IF(WrongAnswerType::SELECTED_JOB_DOES_NOT_EXIST,
+                    !job_exists(id), "one of selected jobs does not exist");
+        THROW_WA_IF(WrongAnswerType::DUPS_IN_SELECTED_JOBS, !ids.set(id),
+                    "duplicate in selected jobs");
+    }
+    accept_jobs_(ids);
+    INFO("The selected jobs have been accepted successfully.");
+}
 void JobManager::accept_all_jobs() {
-    std::unordered_set<job_id_t> all_jobs;
-    for_each_job([&](job_id_t id) { all_jobs.emplace(id); });
+    IdBitset all_jobs(job_num());
+    for_each_job([&](job_id_t id) { all_jobs.set(id); });
     accept_jobs_(all_jobs, true);
 }
-void JobManager::accept_jobs_(const std::unordered_set<job_id_t>& acc_jobs,
-                              bool fast_all_jobs) {
+void JobManager::accept_jobs_(const IdBitset& acc_jobs, bool fast_all_jobs) {
     THROW_LOGIC_ERROR_IF(done_job_acceptance(),
                          "Job acceptance is already done.");
+    THROW_LOGIC_ERROR_IF(acc_jobs.size() != job_num(),
+                         "The accepted job set is not sized to job_num");
     if (fast_all_jobs) {
-        THROW_LOGIC_ERROR_IF(job_num() != acc_jobs.size(),
+        THROW_LOGIC_ERROR_IF(job_num() != acc_jobs.count(),
                              "Specified fast_all_jobs but job_num is not equal "
                              "to accepted job num");
         accepted_jobs_ = acc_jobs;
-        relevant_jobs_.clear();
-        relevant_jobs_.insert(acc_jobs.begin(), acc_jobs.end());
+        relevant_jobs_ = acc_jobs.ids();
     } else {
-        for (const auto& jkv : jobs_) {
-            if (jkv.second.info.mandatory) {
+        for (const auto& job : jobs_) {
+            if (job.info().mandatory) {
                 THROW_WA_IF(WrongAnswerType::MUST_SELECT_ALL_MANDATORY_JOBS,
-                            acc_jobs.find(jkv.second.id()) == acc_jobs.end(),
+                            !acc_jobs.test(job.id()),
                             "All the mandatory jobs have to be accepted.");
             }
         }
-        accepted_jobs_.clear();
-        for (const auto& aid : acc_jobs) {
-            THROW_WA_IF(WrongAnswerType::SELECTED_JOB_DOES_NOT_EXIST,
-                        !job_exists(aid),
-                        "Tried to accept jobs which do not exist.");
-            for (auto dep_id : jobs(aid).info.dependency) {
+        acc_jobs.for_each([&](job_id_t aid) {
+            for (auto dep_id : jobs(aid).info().dependency) {
                 THROW_WA_IF(WrongAnswerType::MUST_SELECT_ALL_DEPENDENCIES,
-                            acc_jobs.find(dep_id) == acc_jobs.end(),
+                            !acc_jobs.test(dep_id),
                             "For every job, all jobs that it "
                             "depends on must be included.");
             }
-            accepted_jobs_.insert(aid);
-        }
-        std::unordered_set<job_id_t> unsorted_rel;
-        for (const auto& aid : accepted_jobs_) {
-            if (unsorted_rel.find(aid) == unsorted_rel.end()) {
-                unsorted_rel.merge(get_all_relevant_jobs_(aid));
-            }
+        });
+        accepted_jobs_ = acc_jobs;
+        relevant_jobs_ = get_all_relevant_jobs_(accepted_jobs_).ids();
+    }
+    completed_jobs_.assign(job_num());
+    executed_jobs_.assign(job_num());
+    pending_jobs_.assign(job_num());
+    reset_dependency_counters_();
+    newly_ready_jobs_.clear();
+    for (auto id : relevant_jobs_) {
+        if (accepted_jobs_.test(id) && unfinished_dep_num_[id] == 0) {
+            newly_ready_jobs_.push_back(id);
         }
-        relevant_jobs_.clear();
-        relevant_jobs_.insert(unsorted_rel.begin(), unsorted_rel.end());
     }
     done_job_acceptance_ = true;
 }
-void JobManager::execute_job(discrete_time_t current_time, const Worker& worker,
-                             job_id_t id, int amount) {
-    {
-        std::string msg;
-        THROW_RUNTIME_ERROR_IF(
-            !is_valid(&msg),
-            "JobManager is invalid for the following reason(s):%s",
-            msg.c_str());
+void JobManager::build_dependents_() {
+    auto d = std::make_shared<JobDependents>();
+    d->begin.assign(job_num() + 1, 0);
+    for (const auto& job : jobs_) {
+        for (auto dep_id : job.info().dependency) {
+            THROW_RUNTIME_ERROR_IF(dep_id >= job_num(),
+                                   "Dependency job ID(%d) is out of range.",
+                                   dep_id);
+            d->begin[dep_id + 1]++;
+        }
     }
-    {
-        std::string msg;
-        THROW_RUNTIME_ERROR_IF(
-            !worker.is_valid(&msg),
-            "The worker is invalid for the following reason(s):%s",
-            msg.c_str());
+    for (int i = 0; i < job_num(); i++) {
+        d->begin[i + 1] += d->begin[i];
     }
+    d->ids.resize(d->begin.back());
+    std::vector<int> pos(d->begin.begin(), d->begin.end() - 1);
+    for (const auto& job : jobs_) {
+        for (auto dep_id : job.info().dependency) {
+            d->ids[pos[dep_id]++] = job.id();
+        }
+    }
+    dependents_ = std::move(d);
+}
+void JobManager::reset_dependency_counters_() {
+    THROW_LOGIC_ERROR_IF(!dependents_, "Jobs are not loaded yet.");
+    unfinished_dep_num_.resize(job_num());
+    for (const auto& job : jobs_) {
+        unfinished_dep_num_[job.id()] = job.info().dependency.size();
+    }
+    const JobDependents& d = *dependents_;
+    completed_jobs_.for_each([&](job_id_t id) {
+        for (int i = d.begin[id]; i < d.begin[id + 1]; i++) {
+            unfinished_dep_num_[d.ids[i]]--;
+        }
+    });
+}
+void JobManager::complete_job_(job_id_t id) {
+    const JobDependents& d = *dependents_;
+    for (int i = d.begin[id]; i < d.begin[id + 1]; i++) {
+        const job_id_t dependent = d.ids[i];
+        if (--unfinished_dep_num_[dependent] == 0 &&
+            accepted_jobs_.test(dependent)) {
+            newly_ready_jobs_.push_back(dependent);
+        }
+    }
+}
+void JobManager::execute_job(discrete_time_t current_time, const Worker& worker,
+                             job_id_t id, int amount) {
+    THROW_INVARIANT_ERROR_IF(
+        check() != CheckCode::OK,
+        "JobManager is invalid for the following reason(s):%s",
+        check_code_to_str(check()));
     THROW_WA_IF(WrongAnswerType::EXECUTE_JOB_ID_DOES_NOT_EXIST,
                 id == INVALID_JOB_ID, "Job id is invalid");
     THROW_WA_IF(WrongAnswerType::EXECUTE_JOB_ID_DOES_NOT_EXIST, id < 0,
@@ -120,32 +167,30 @@ void JobManager::execute_job(discrete_time_t current_time, const Worker& worker,
                 "The worker is not on any vertex");
     auto& job = jobs(id);
     THROW_WA_IF(WrongAnswerType::NO_JOB_EXISTS_AT_CURRENT_POS,
-                worker.current_position().u != job.info.position,
-                "Job position(%d) != Worker position(%d)", job.info.position,
+                worker.current_position().u != job.info().position,
+                "Job position(%d) != Worker position(%d)", job.info().position,
                 worker.current_position().u);
     THROW_WA_IF(WrongAnswerType::WORKER_CANNOT_PROCESS_THIS_TYPE,
-                !worker.can_process(job.info.type),
+                !worker.can_process(job.info().type),
                 "The specified job cannot be processed by this "
                 "worker due to its job type restriction.");
-    if (job.info.gain(current_time) <= 0) {
+    const ExactScore gain = job.info().gain(current_time);
+    if (gain.sign() <= 0) {
         std::cerr << "GAIN FUNCTION DEBUG INFO:" << std::endl;
-        std::cerr << job.info.gain_function_data << std::endl;
-        std::cerr << "Adjacent values:" << job.info.gain(current_time - 1)
-                  << " " << job.info.gain(current_time) << " "
-                  << job.info.gain(current_time + 1) << std::endl;
+        std::cerr << job.info().gain_function_data << std::endl;
+        std::cerr << "Adjacent values:" << job.info().gain(current_time - 1)
+                  << " " << gain << " " << job.info().gain(current_time + 1)
+                  << std::endl;
     }
-    THROW_WA_IF(WrongAnswerType::NONPOSITIVE_REWARD_VALUE,
-                job.info.gain(current_time) <= 0,
+    THROW_WA_IF(WrongAnswerType::NONPOSITIVE_REWARD_VALUE, gain.sign() <= 0,
                 "Cannot be processed when the gain value is zero or "
                 "negative.(t=%d,v=%s)",
-                current_time, job.info.gain(current_time).str().c_str());
+                current_time, gain.str().c_str());
     {
         const weather_value_t weather_value =
             weather_man_->get_weather_value(current_time);
         const int task_limit =
-            tl_info_->task_limit(worker.info.max_task,
-                                 job.info.weather_dependency,
-                                 weather_value);
+            task_limit_(job, worker.info.max_task, weather_value);
         THROW_WA_IF(WrongAnswerType::EXCEEDS_TASK_EXECUTION_LIMIT,
                     amount > task_limit,
                     "The specified task amount exceeds current task "
@@ -153,63 +198,57 @@ void JobManager::execute_job(discrete_time_t current_time, const Worker& worker,
                     task_limit, amount, weather_value);
     }
     THROW_WA_IF(WrongAnswerType::EXCEEDS_TASK_AMOUNT_REST,
-                amount + job.state.task_cumul() > job.info.n_task,
+                amount + job.state.task_cumul() > job.info().n_task,
                 "Total task amount exceeds n_task of the specified job.");
-    for (auto dep_id : job.info.dependency) {
-        THROW_LOGIC_ERROR_IF(
-            !job_exists(dep_id),
-            "Some jobs on which the specifed job depends do not exist.");
-        THROW_WA_IF(
-            WrongAnswerType::DEPENDENCIES_NOT_DONE, !jobs(dep_id).completed(),
-            "Some jobs on which the specified job depends are not completed.");
-    }
-    float_score_t gained_score = amount * job.info.gain(current_time);
-    score_man_->add_score_jobwise(id, gained_score);
+    THROW_WA_IF(
+        WrongAnswerType::DEPENDENCIES_NOT_DONE, unfinished_dep_num_[id] != 0,
+        "Some jobs on which the specified job depends are not completed.");
+    score_man_->add_score_jobwise(id, gain * amount);
     job.task_done_NOT_FINALIZED(amount);
-    executed_jobs_.emplace(id);
-}
-std::unordered_set<job_id_t>
-JobManager::get_all_relevant_jobs_(job_id_t id) const {
-    THROW_LOGIC_ERROR_IF(id == INVALID_JOB_ID, "Job ID is invalid");
-    THROW_LOGIC_ERROR_IF(id < 0, "Job ID is negative (internal).");
-    THROW_LOGIC_ERROR_IF(
-        !job_exists(id),
-        "(while finding all relevant jobs) The specified job does not exist.");
-    if (relevant_jobs_memoized_.find(id) != relevant_jobs_memoized_.end()) {
-        return relevant_jobs_memoized_.at(id);
-    }
-    std::unordered_set<job_id_t> ret{id};
-    for (job_id_t dep_id : jobs(id).info.dependency) {
-        ret.merge(get_all_relevant_jobs_(dep_id));
+    executed_jobs_.set(id);
+    pending_jobs_.set(id);
+}
+IdBitset JobManager::get_all_relevant_jobs_(const IdBitset& origins) const {
+    IdBitset ret(job_num());
+    std::vector<job_id_t> stack;
+    origins.for_each([&](job_id_t id) {
+        if (ret.set(id)) {
+            stack.push_back(id);
+        }
+    });
+    while (!stack.empty()) {
+        const job_id_t id = stack.back();
+        stack.pop_back();
+        for (job_id_t dep_id : jobs(id).info().dependency) {
+            THROW_LOGIC_ERROR_IF(!job_exists(dep_id),
+                                 "(while finding all relevant jobs) The "
+                                 "specified job does not exist.");
+            if (ret.set(dep_id)) {
+                stack.push_back(dep_id);
+            }
+        }
     }
-    auto p = relevant_jobs_memoized_.emplace(id, std::move(ret));
-    THROW_LOGIC_ERROR_IF(!p.second, "Failed to memoize dependency graph.");
-    return p.first->second;
+    return ret;
 }
 bool JobManager::completed_all_jobs() const {
     THROW_LOGIC_ERROR_IF(!done_job_acceptance(),
                          "Job acceptance phase is not finished yet.");
-    for (auto id : accepted_jobs_) {
-        if (!jobs(id).completed()) {
-            return false;
-        }
-    }
-    return true;
+    return completed_jobs_.count() == accepted_jobs_.count();
+}
+CheckCode JobManager::check() const {
+    RETURN_CHECK_CODE_IF(world_type() == WorldType::INVALID,
+                         JOB_MANAGER_WORLD_TYPE_IS_INVALID);
+    RETURN_CHECK_CODE_IF(weather_man_ == nullptr,
+                         JOB_MANAGER_WEATHER_MANAGER_IS_NOT_SET);
+    RETURN_CHECK_CODE_IF(tl_info_ == nullptr,
+                         JOB_MANAGER_TASK_LIMIT_INFO_IS_NOT_SET);
+    RETURN_CHECK_CODE_IF(score_man_ == nullptr,
+                         JOB_MANAGER_SCORE_MANAGER_IS_NOT_SET);
+    RETURN_CHECK_CODE_IF(jobs_.empty(), JOB_MANAGER_HAS_NO_JOB);
+    return CheckCode::OK;
 }
 bool JobManager::is_valid(std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    VALIDITY_CHECK_WITH_MSG(world_type() == WorldType::INVALID, valid, msg,
-                            "World type is invalid.");
-    VALIDITY_CHECK_WITH_MSG(weather_man_ == nullptr, valid, msg,
-                            "WeatherManager is not set.");
-    VALIDITY_CHECK_WITH_MSG(tl_info_ == nullptr, valid, msg,
-                            "TaskLimitInfo is not set.");
-    VALIDITY_CHECK_WITH_MSG(score_man_ == nullptr, valid, msg,
-                            "ScoreManager is not set.");
-    VALIDITY_CHECK_WITH_MSG(jobs_.empty(), valid, msg, "Job set is empty.");
-    return valid;
+    return report_check(check(), msg);
 }
 void JobManager::set_weather_manager(const WeatherManager* wmp) {
     weather_man_ = wmp;
@@ -225,18 +264,40 @@ void JobManager::read_jobs(std::istream& is) {
     int n;
     readline_exact(r, TAG(ValueGroup::COUNT, n));
     THROW_RUNTIME_ERROR_IF(n <= 0, "Job count(%d) is invalid", n);
+    jobs_.reserve(jobs_.size() + n);
     for (int i = 0; i < n; i++) {
-        int id = id_gen++;
-        auto& job = jobs_[id];
+        const job_id_t id = jobs_.size();
+        auto& job = jobs_.emplace_back();
         job.id_ = id;
         job.read_job_info(world_type(), is);
         job.initialize_state();
         THROW_RUNTIME_ERROR_IF(world_type() == WorldType::A &&
-                                   job.info.mandatory,
+                                   job.info().mandatory,
                                "Mandatody jobs should not exist in Task A");
     }
+    build_dependents_();
     INFO("Job data loaded successfully.");
 }
+void JobManager::build_task_limit_table() {
+    THROW_LOGIC_ERROR_IF(tl_info_ == nullptr, "TaskLimitInfo is not set.");
+    weather_value_num_ = tl_info_->limit_constant_num();
+    auto factors =
+        std::make_shared<std::vector<double>>(job_num() * weather_value_num_);
+    for (const auto& job : jobs_) {
+        for (weather_value_t w = 0; w < weather_value_num_; w++) {
+            (*factors)[job.id() * weather_value_num_ + w] =
+                tl_info_->task_limit_factor(job.info().weather_dependency, w);
+        }
+    }
+    task_limit_factors_ = std::move(factors);
+}
+int JobManager::task_limit_(const Job& job, int n_max,
+                            weather_value_t weather) const {
+    THROW_LOGIC_ERROR_IF(weather < 0 || weather >= weather_value_num_,
+                         "Weather value(%d) is out of range.", weather);
+    return n_max *
+           (*task_limit_factors_)[job.id() * weather_value_num_ + weather];
+}
 const Job& JobManager::jobs(job_id_t id) const {
     return jobs_.at(id);
 }
@@ -244,54 +305,92 @@ Job& JobManager::jobs(job_id_t id) {
     return jobs_.at(id);
 }
 bool JobManager::job_exists(job_id_t id) const {
-    return jobs_.find(id) != jobs_.end();
+    return 0 <= id && id < job_num();
 }
 bool JobManager::is_job_accepted(job_id_t id) const {
-    return accepted_jobs_.find(id) != accepted_jobs_.end();
+    return accepted_jobs_.in_range(id) && accepted_jobs_.test(id);
+}
+int JobManager::executed_job_num() const {
+    return executed_jobs_.count();
 }
 int JobManager::relevant_job_num() const {
-    int c = 0;
-    for_each_relevant_job([&](...) { c++; });
-    return c;
+    THROW_LOGIC_ERROR_IF(!done_job_acceptance(),
+                         "Finish job acceptance phase first.");
+    return relevant_jobs_.size();
 }
 int JobManager::unfinished_relevant_job_num() const {
-    int c = 0;
-    for_each_unfinished_relevant_job([&](...) { c++; });
-    return c;
+    return relevant_job_num() - completed_jobs_.count();
 }
 bool JobManager::dependency_done(job_id_t id) const {
-    const Job& job = jobs(id);
-    for (auto dep : job.info.dependency) {
-        if (!jobs(dep).completed()) {
-            return false;
-        }
-    }
-    return true;
+    return unfinished_dependency_num(id) == 0;
+}
+int JobManager::unfinished_dependency_num(job_id_t id) const {
+    THROW_LOGIC_ERROR_IF(!done_job_acceptance(),
+                         "Job acceptance phase is not finished yet.");
+    THROW_LOGIC_ERROR_IF(!job_exists(id), "The specified job does not exist.");
+    return unfinished_dep_num_[id];
 }
 void JobManager::update_other_jobs(discrete_time_t t) {
 }
 int JobManager::job_num() const {
     return jobs_.size();
 }
-void JobManager::log_mutable_info_only(discrete_time_t crt0b, bool e) const {
-    this->LogInfoSwitcher::log_mutable_info_only(crt0b, e);
-    for_each_job(
-        [&](job_id_t id) { jobs(id).log_mutable_info_only(crt0b, e); });
+void JobManager::write_turn_log(BinaryLogWriter& w) const {
+    for_each_relevant_job(
+        [&](job_id_t id) { w.add_task_cumul(jobs(id).state.task_cumul()); });
+}
+void JobManager::write_turn_log(JsonLogWriter& w) const {
+    w.begin_object();
+    w.key("relevant_jobs");
+    w.begin_array();
+    for_each_relevant_job([&](job_id_t id) { jobs(id).write_turn_log(w); });
+    w.end_array();
+    w.end_object();
+}
+void JobManager::snapshot(SnapshotWriter& w) const {
+    w.write<uint64_t>(jobs_.size());
+    for (const auto& job : jobs_) {
+        job.state.snapshot(w);
+    }
+    executed_jobs_.snapshot(w);
+    w.write_sequence(newly_ready_jobs_);
+}
+void JobManager::restore(SnapshotReader& r) {
+    THROW_LOGIC_ERROR_IF(r.read<uint64_t>() != jobs_.size(),
+                         "Job num of the snapshot does not match.");
+    for (auto& job : jobs_) {
+        job.state.restore(r);
+    }
+    executed_jobs_.restore(r);
+    r.read_sequence(newly_ready_jobs_);
+    rebuild_job_flags_();
+}
+void JobManager::rebuild_job_flags_() {
+    completed_jobs_.clear();
+    pending_jobs_.clear();
+    for (auto id : relevant_jobs_) {
+        if (jobs_[id].completed()) {
+            completed_jobs_.set(id);
+        }
+        if (jobs_[id].state.pending_task_done() != 0) {
+            pending_jobs_.set(id);
+        }
+    }
+    reset_dependency_counters_();
 }
 void to_json(json_ref j, const JobManager& jm) {
-    if (jm.log_mutable_only_) {
-        std::vector<std::reference_wrapper<const Job>> reljobrefs;
-        jm.for_each_relevant_job(
-            [&](job_id_t id) { reljobrefs.push_back(jm.jobs(id)); });
-        j = json{
-            {"relevant_jobs", reljobrefs},
-        };
-    } else {
-        j = json{
-            {"jobs", jm.jobs_},
-            {"done_job_acceptance", jm.done_job_acceptance_},
-            {"accepted_job_ids", jm.accepted_jobs_},
-            {"relevant_job_ids", jm.relevant_jobs_},
-        };
+    json jobs = json::array();
+    for (const auto& job : jm.jobs_) {
+        jobs.push_back(json::array({job.id(), job}));
+    }
+    std::vector<job_id_t> accepted_job_ids;
+    if (jm.done_job_acceptance_) {
+        accepted_job_ids = jm.accepted_jobs_.ids();
     }
+    j = json{
+        {"jobs", std::move(jobs)},
+        {"done_job_acceptance", jm.done_job_acceptance_},
+        {"accepted_job_ids", accepted_job_ids},
+        {"relevant_job_ids", jm.relevant_jobs_},
+    };
 }
@@ -1,56 +1,72 @@
 #ifndef HEADER_2HC2022_JOB_MANAGER
 #define HEADER_2HC2022_JOB_MANAGER 
-#include <atomic>
-#include <map>
-#include <set>
+#include <algorithm>
+#include <memory>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
+#include "id_bitset.hpp"
 #include "io.hpp"
 #include "job.hpp"
 #include "json_fwd.hpp"
 #include "score.hpp"
 #include "weather.hpp"
 #include "worker.hpp"
-class JobManager : public LogInfoSwitcher {
+// Reverse dependency lists in CSR form: the jobs depending on job i are
+// ids[begin[i]] .. ids[begin[i + 1] - 1].
+struct JobDependents {
+    std::vector<int> begin;
+    std::vector<job_id_t> ids;
+};
+class JobManager {
     const WeatherManager* weather_man_ = nullptr;
     const TaskLimitInfo* tl_info_ = nullptr;
     ScoreManager* score_man_ = nullptr;
-    std::map<job_id_t, Job> jobs_;
-    std::atomic<int> id_gen{0};
+    std::vector<Job> jobs_;
     bool done_job_acceptance_ = false;
-    std::unordered_set<job_id_t> accepted_jobs_;
-    void accept_jobs_(const std::unordered_set<job_id_t>& acc_jobs,
-                      bool fast_all_jobs = false);
-    mutable std::unordered_map<job_id_t, std::unordered_set<job_id_t>>
-        relevant_jobs_memoized_;
-    std::set<job_id_t> relevant_jobs_;
-    std::unordered_set<job_id_t> get_all_relevant_jobs_(job_id_t origin) const;
+    IdBitset accepted_jobs_;
+    std::vector<job_id_t> relevant_jobs_;
+    IdBitset completed_jobs_;
+    IdBitset executed_jobs_;
+    IdBitset pending_jobs_;
+    std::shared_ptr<const JobDependents> dependents_;
+    std::vector<int> unfinished_dep_num_;
+    std::vector<job_id_t> newly_ready_jobs_;
+    std::shared_ptr<const std::vector<double>> task_limit_factors_;
+    int weather_value_num_ = 0;
+    int task_limit_(const Job& job, int n_max, weather_value_t weather) const;
+    void build_dependents_();
+    void reset_dependency_counters_();
+    void complete_job_(job_id_t id);
+    void accept_jobs_(const IdBitset& acc_jobs, bool fast_all_jobs = false);
+    IdBitset get_all_relevant_jobs_(const IdBitset& origins) const;
+    void rebuild_job_flags_();
     WorldType world_type_ = WorldType::INVALID;
  public:
-    std::unordered_set<job_id_t> executed_jobs_;
-    void log_mutable_info_only(discrete_time_t crt0b, bool e) const override;
     void set_world_type(WorldType wt);
     WorldType world_type() const;
     bool done_job_acceptance() const;
     template <class Fn> void for_each_accepted_job(const Fn& f) const {
         THROW_LOGIC_ERROR_IF(!done_job_acceptance(),
                              "Job acceptance phase is not finished yet.");
-        for (auto id : accepted_jobs_) {
-            f(id);
-        }
+        accepted_jobs_.for_each(f);
     }
     template <class Fn> void for_each_job(const Fn& f) const {
-        for (const auto& kv : jobs_) {
-            f(kv.first);
+        for (job_id_t id = 0; id < job_num(); id++) {
+            f(id);
         }
     }
+    template <class Fn> void for_each_executed_job(const Fn& f) const {
+        executed_jobs_.for_each(f);
+    }
+    int executed_job_num() const;
     bool completed_all_jobs() const;
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
     void set_weather_manager(const WeatherManager* wmp);
     void set_task_limit_info(const TaskLimitInfo* tlip);
     void set_score_manager(ScoreManager* sm);
     void read_jobs(std::istream& is);
+    void build_task_limit_table();
     const Job& jobs(job_id_t id) const;
     Job& jobs(job_id_t id);
     bool job_exists(job_id_t id) const;
@@ -58,6 +74,7 @@ class JobManager : public LogInfoSwitcher {
     void execute_job(discrete_time_t current_time, const Worker& worker,
                      job_id_t id, int amount);
     void accept_jobs(std::istream& is);
+    void accept_jobs(const std::vector<job_id_t>& ids);
     void accept_all_jobs();
     template <class Fn> void for_each_relevant_job(const Fn& callback) const {
         if (!done_job_acceptance()) {
@@ -71,15 +88,38 @@ class JobManager : public LogInfoSwitcher {
     template <class Fn>
     void for_each_unfinished_relevant_job(const Fn& callback) const {
         for_each_relevant_job([&](job_id_t jid) {
-            if (!jobs(jid).completed()) {
+            if (!completed_jobs_.test(jid)) {
                 callback(jid);
             }
         });
     }
     int unfinished_relevant_job_num() const;
     bool dependency_done(job_id_t id) const;
+    int unfinished_dependency_num(job_id_t id) const;
+    template <class Fn> void for_each_newly_ready_job(const Fn& f) const {
+        for (auto id : newly_ready_jobs_) {
+            f(id);
+        }
+    }
+    template <class Fn> void finalize_task_done(const Fn& on_completed) {
+        newly_ready_jobs_.clear();
+        pending_jobs_.for_each([&](job_id_t id) {
+            auto& job = jobs_[id];
+            job.finalize_task_done();
+            if (job.completed() && completed_jobs_.set(id)) {
+                on_completed(id);
+                complete_job_(id);
+            }
+        });
+        pending_jobs_.clear();
+        std::sort(newly_ready_jobs_.begin(), newly_ready_jobs_.end());
+    }
     void update_other_jobs(discrete_time_t t);
     int job_num() const;
+    void snapshot(SnapshotWriter& w) const;
+    void write_turn_log(JsonLogWriter& w) const;
+    void write_turn_log(BinaryLogWriter& w) const;
+    void restore(SnapshotReader& r);
     friend void to_json(json_ref j, const JobManager& jm);
 };
 #endif
@@ -0,0 +1,132 @@
+#ifndef HEADER_2HC2022_JSON_LOG
+#define HEADER_2HC2022_JSON_LOG 
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <vector>
+#include "lib/json.hpp"
+// Writes json straight into a stream without building a DOM. The output is
+// byte-identical to json::dump() as long as callers write object keys in
+// the (sorted) order nlohmann::json would.
+class JsonLogWriter {
+    std::streambuf* sb_;
+    std::vector<bool> need_comma_;
+    char buf_[64];
+    void put_(char c) {
+        sb_->sputc(c);
+    }
+    void put_(std::string_view s) {
+        sb_->sputn(s.data(), s.size());
+    }
+    void separate_() {
+        if (need_comma_.empty()) {
+            return;
+        }
+        if (need_comma_.back()) {
+            put_(',');
+        }
+        need_comma_.back() = true;
+    }
+    void put_escaped_(std::string_view s) {
+        put_('"');
+        for (char c : s) {
+            switch (c) {
+                case '"':
+                    put_("\\\"");
+                    break;
+                case '\\':
+                    put_("\\\\");
+                    break;
+                case '\b':
+                    put_("\\b");
+                    break;
+                case '\f':
+                    put_("\\f");
+                    break;
+                case '\n':
+                    put_("\\n");
+                    break;
+                case '\r':
+                    put_("\\r");
+                    break;
+                case '\t':
+                    put_("\\t");
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        static const char hex[] = "0123456789abcdef";
+                        put_("\\u00");
+                        put_(hex[(c >> 4) & 0xf]);
+                        put_(hex[c & 0xf]);
+                    } else {
+                        put_(c);
+                    }
+            }
+        }
+        put_('"');
+    }
+ public:
+    explicit JsonLogWriter(std::ostream& os) : sb_(os.rdbuf()) {
+    }
+    void begin_object() {
+        separate_();
+        put_('{');
+        need_comma_.push_back(false);
+    }
+    void end_object() {
+        need_comma_.pop_back();
+        put_('}');
+    }
+    void begin_array() {
+        separate_();
+        put_('[');
+        need_comma_.push_back(false);
+    }
+    void end_array() {
+        need_comma_.pop_back();
+        put_(']');
+    }
+    void key(std::string_view k) {
+        separate_();
+        put_escaped_(k);
+        put_(':');
+        need_comma_.back() = false;
+    }
+    void value(int64_t v) {
+        separate_();
+        auto res = std::to_chars(buf_, buf_ + sizeof(buf_), v);
+        put_(std::string_view(buf_, res.ptr - buf_));
+    }
+    void value(int v) {
+        value(static_cast<int64_t>(v));
+    }
+    void value(bool v) {
+        separate_();
+        put_(v ? "true" : "false");
+    }
+    void value(double v) {
+        separate_();
+        if (!std::isfinite(v)) {
+            put_("null");
+            return;
+        }
+        char* end = nlohmann::detail::to_chars(buf_, buf_ + sizeof(buf_), v);
+        put_(std::string_view(buf_, end - buf_));
+    }
+    void value(std::string_view v) {
+        separate_();
+        put_escaped_(v);
+    }
+    void value(const char* v) {
+        value(std::string_view(v));
+    }
+    template <class K, class V> void pair(const K& k, const V& v) {
+        begin_array();
+        value(k);
+        value(v);
+        end_array();
+    }
+};
+#endif
@@ -0,0 +1,34 @@
+#ifndef HEADER_2HC2022_PHILOX
+#define HEADER_2HC2022_PHILOX 
+#include <array>
+#include <cstdint>
+// Counter-based generator Philox4x32-10 (Salmon et al., "Parallel random
+// numbers: as easy as 1, 2, 3"). Each output block is a pure function of
+// (counter, key).
+class Philox4x32 {
+ public:
+    using counter_t = std::array<uint32_t, 4>;
+    using key_t = std::array<uint32_t, 2>;
+    static counter_t generate(counter_t ctr, key_t key) {
+        for (int i = 0; i < 10; i++) {
+            if (i > 0) {
+                key[0] += 0x9E3779B9;
+                key[1] += 0xBB67AE85;
+            }
+            const uint64_t p0 = uint64_t(0xD2511F53) * ctr[0];
+            const uint64_t p1 = uint64_t(0xCD9E8D57) * ctr[2];
+            ctr = {static_cast<uint32_t>(p1 >> 32) ^ ctr[1] ^ key[0],
+                   static_cast<uint32_t>(p1),
+                   static_cast<uint32_t>(p0 >> 32) ^ ctr[3] ^ key[1],
+                   static_cast<uint32_t>(p0)};
+        }
+        return ctr;
+    }
+    static uint64_t generate64(const counter_t& ctr, uint64_t key) {
+        const counter_t r =
+            generate(ctr, {static_cast<uint32_t>(key),
+                           static_cast<uint32_t>(key >> 32)});
+        return (uint64_t(r[1]) << 32) | r[0];
+    }
+};
+#endif
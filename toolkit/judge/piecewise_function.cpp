@@ -13,14 +13,12 @@ void sorted_point_sequence::invalidate_() {
 const sorted_point_sequence& sorted_point_sequence::as_const() const {
     return std::as_const(*this);
 }
+CheckCode sorted_point_sequence::check() const {
+    RETURN_CHECK_CODE_IF(!validated_, POINT_SEQUENCE_IS_NOT_VALIDATED);
+    return CheckCode::OK;
+}
 bool sorted_point_sequence::is_valid(std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    VALIDITY_CHECK_WITH_MSG(!validated_, valid, msg,
-                            "This sorted point sequence is not validated yet. "
-                            "Validate or fix the sequence data.");
-    return valid;
+    return report_check(check(), msg);
 }
 bool sorted_point_sequence::is_sorted() const {
     for (size_type i = 0; i < sq_.size() - 1; i++) {
@@ -63,11 +61,11 @@ piecewise_constant_function(const sorted_point_sequence& sorted_points,
     size_t n = sorted_points.size();
     THROW_LOGIC_ERROR_IF(n == 0, "point sequence is empty.");
     {
-        std::string msg;
+        const CheckCode code = sorted_points.check();
         THROW_RUNTIME_ERROR_IF(
-            !sorted_points.is_valid(&msg),
+            code != CheckCode::OK,
             "point sequence is invalid for the following reason(s):%s",
-            msg.c_str());
+            check_code_to_str(code));
     }
     auto it = std::upper_bound(
         sorted_points.begin(), sorted_points.end(), t,
@@ -79,17 +77,17 @@ piecewise_constant_function(const sorted_point_sequence& sorted_points,
     }
     return (--it)->second;
 }
-float_score_t
+ExactScore
 piecewise_linear_function(const sorted_point_sequence& sorted_points,
                           discrete_time_t t) {
     size_t n = sorted_points.size();
     THROW_LOGIC_ERROR_IF(n == 0, "point sequence is empty.");
     {
-        std::string msg;
+        const CheckCode code = sorted_points.check();
         THROW_RUNTIME_ERROR_IF(
-            !sorted_points.is_valid(&msg),
+            code != CheckCode::OK,
             "point sequence is invalid for the following reason(s):%s",
-            msg.c_str());
+            check_code_to_str(code));
     }
     auto it = std::upper_bound(
         sorted_points.begin(), sorted_points.end(), t,
@@ -104,10 +102,9 @@ piecewise_linear_function(const sorted_point_sequence& sorted_points,
     }
     auto [t2, v2] = *it;
     auto [t1, v1] = *--it;
-    return (float_score_t{v2} - float_score_t{v1}) *
-               (float_score_t{t} - float_score_t{t1}) /
-               (float_score_t{t2} - float_score_t{t1}) +
-           float_score_t{v1};
+    return ExactScore::ratio(static_cast<__int128>(v2 - v1) * (t - t1) +
+                                 static_cast<__int128>(v1) * (t2 - t1),
+                             t2 - t1);
 }
 std::ostream& operator<<(std::ostream& os, const sorted_point_sequence& ps) {
     json j = ps;
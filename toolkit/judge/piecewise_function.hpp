@@ -4,6 +4,8 @@
 #include <utility>
 #include <vector>
 #include "defines.hpp"
+#include "error_check.hpp"
+#include "exact_score.hpp"
 #include "json_fwd.hpp"
 using point_sequence_raw =
     std::vector<std::pair<discrete_time_t, simple_score_t>>;
@@ -13,6 +15,7 @@ class sorted_point_sequence {
     void invalidate_();
  public:
     const sorted_point_sequence& as_const() const;
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
     using size_type = point_sequence_raw::size_type;
     using value_type = point_sequence_raw::value_type;
@@ -82,7 +85,7 @@ class sorted_point_sequence {
 float_score_t
 piecewise_constant_function(const sorted_point_sequence& sorted_points,
                             discrete_time_t t);
-float_score_t
+ExactScore
 piecewise_linear_function(const sorted_point_sequence& sorted_points,
                           discrete_time_t t);
 std::ostream& operator<<(std::ostream& os, const sorted_point_sequence& ps);
@@ -1,24 +1,141 @@
+#include <csignal>
 #include <fstream>
+#include "lib/cmdline.h"
+#include "solver.hpp"
+#include "solver_process.hpp"
+#include "turn_profiler.hpp"
 #include "world.hpp"
 int main(int argc, char** argv) {
-    if (argc == 1) {
-        std::cerr << "Usage: ./playground <world_info_file> "
-                     "<OPTIONAL:json_log_output_file>"
-                  << std::endl;
+    cmdline::parser p;
+    p.add<std::string>(
+        "solver", 's',
+        "ソルバの共有ライブラリ(HC2022_EXPORT_SOLVERでエクスポートしたもの)。"
+        "指定時は標準入出力を使わず同一プロセス内で実行する",
+        false, "");
+    p.add<std::string>(
+        "command", 'c',
+        "解答プログラムを実行するコマンド(/bin/sh -cで実行する)。"
+        "指定時はジャッジが解答プログラムを起動し、パイプで直接やり取りする",
+        false, "");
+    p.add<double>("turn-time-limit", 't',
+                  "--command使用時の1ターンあたりの制限時間[ms](0:無制限)",
+                  false, 0.0);
+    p.add<double>("time-limit", 'T',
+                  "--command使用時の解答プログラムの出力待ち時間の合計の制限[ms]"
+                  "(0:無制限)",
+                  false, 0.0);
+    p.add<std::string>("input-transcript", 'i',
+                       "--command使用時に解答プログラムへの入力を保存する先",
+                       false, "");
+    p.add<std::string>("output-transcript", 'o',
+                       "--command使用時に解答プログラムの出力を保存する先"
+                       "(--replayで再生できる)",
+                       false, "");
+    p.add<std::string>(
+        "replay", 'r',
+        "記録済みの解答プログラムの出力(judge.shのdebug_output.txt等)を再生する。"
+        "ジャッジの出力は捨てられる",
+        false, "");
+    p.add<std::string>(
+        "binary-log", 'b',
+        "カラム形式のバイナリログの出力先(judge/binlog_to_jsonでJSONに変換できる)",
+        false, "");
+    p.add<std::string>(
+        "seekable-log", 'k',
+        "キーフレーム付きのシーク可能なログの出力先(SeekableLogで任意のターンの状態を復元できる)",
+        false, "");
+    p.add<int>("keyframe-interval", 'K', "シーク可能なログのキーフレーム間隔",
+               false, DEFAULT_KEYFRAME_INTERVAL, cmdline::range(1, 1 << 30));
+    p.add("profile", 'p',
+          "ターンごとの各処理(入出力・検証・ログ出力等)の所要時間を計測し、"
+          "終了時に標準エラー出力へ報告する");
+    p.add("profile-in-log", '\0',
+          "--profileの計測結果をJSONログにも埋め込む");
+    p.footer("<world_info_file> <OPTIONAL:json_log_output_file>");
+    p.parse_check(argc, argv);
+    if (p.rest().empty() || p.rest().size() > 2) {
+        std::cerr << p.usage();
         exit(1);
     }
-    std::ifstream ifs(argv[1]);
+    std::ifstream ifs(p.rest()[0]);
     if (!ifs) {
-        throw std::runtime_error("Failed to open the file:" +
-                                 std::string(argv[1]));
+        throw std::runtime_error("Failed to open the file:" + p.rest()[0]);
     }
     std::ofstream logofs;
+    std::ofstream binlogofs;
+    std::ofstream seeklogofs;
     World world;
-    if (argc == 3) {
-        logofs.open(argv[2]);
+    if (p.rest().size() == 2) {
+        logofs.open(p.rest()[1]);
         world.set_json_log_output_stream(&logofs);
     }
+    if (!p.get<std::string>("binary-log").empty()) {
+        binlogofs.open(p.get<std::string>("binary-log"), std::ios::binary);
+        world.set_binary_log_output_stream(&binlogofs);
+    }
+    if (!p.get<std::string>("seekable-log").empty()) {
+        seeklogofs.open(p.get<std::string>("seekable-log"), std::ios::binary);
+        world.set_seekable_log_output_stream(&seeklogofs,
+                                             p.get<int>("keyframe-interval"));
+    }
+    TurnProfiler profiler;
+    const bool profile = p.exist("profile") || p.exist("profile-in-log");
+    if (profile) {
+        world.set_turn_profiler(&profiler, p.exist("profile-in-log"));
+    }
     world.initialize();
     world.read_from_stream(ifs);
+    if (!p.get<std::string>("solver").empty()) {
+        SolverLibrary lib;
+        lib.open(p.get<std::string>("solver"));
+        auto solver = lib.create();
+        final_result_t score = world.run(*solver);
+        std::cout << score << std::endl;
+        if (profile) {
+            profiler.write_report(std::cerr);
+        }
+        return 0;
+    }
+    if (!p.get<std::string>("command").empty()) {
+        signal(SIGPIPE, SIG_IGN);
+        std::ofstream input_transcript;
+        std::ofstream output_transcript;
+        if (!p.get<std::string>("input-transcript").empty()) {
+            input_transcript.open(p.get<std::string>("input-transcript"));
+        }
+        if (!p.get<std::string>("output-transcript").empty()) {
+            output_transcript.open(p.get<std::string>("output-transcript"));
+        }
+        SolverProcess solver(p.get<std::string>("command"));
+        solver.set_time_limit({p.get<double>("turn-time-limit"),
+                               p.get<double>("time-limit")});
+        solver.set_transcript(
+            input_transcript.is_open() ? &input_transcript : nullptr,
+            output_transcript.is_open() ? &output_transcript : nullptr);
+        final_result_t score = solver.run(world);
+        std::cout << score << std::endl;
+        solver.write_report(std::cerr);
+        if (profile) {
+            profiler.write_report(std::cerr);
+        }
+        return 0;
+    }
+    if (!p.get<std::string>("replay").empty()) {
+        std::ifstream transcript(p.get<std::string>("replay"));
+        if (!transcript) {
+            throw std::runtime_error("Failed to open the file:" +
+                                     p.get<std::string>("replay"));
+        }
+        std::ostream null_os(nullptr);
+        final_result_t score = world.interact(transcript, null_os);
+        std::cout << score << std::endl;
+        if (profile) {
+            profiler.write_report(std::cerr);
+        }
+        return 0;
+    }
     world.interact(std::cin, std::cout);
+    if (profile) {
+        profiler.write_report(std::cerr);
+    }
 }
@@ -0,0 +1,271 @@
+#ifndef HEADER_2HC2022_PROCESS
+#define HEADER_2HC2022_PROCESS 
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <vector>
+extern char** environ;
+class FileDescriptorBuffer : public std::streambuf {
+ public:
+    using clock = std::chrono::steady_clock;
+ private:
+    int fd_ = -1;
+    std::vector<char> in_buf_;
+    std::vector<char> out_buf_;
+    std::ostream* in_transcript_ = nullptr;
+    std::ostream* out_transcript_ = nullptr;
+    clock::time_point deadline_ = clock::time_point::max();
+    clock::duration wait_budget_ = clock::duration::max();
+    clock::duration own_waited_ = clock::duration::zero();
+    clock::duration* waited_ = &own_waited_;
+    bool timed_out_ = false;
+    bool wait_(short events) {
+        while (true) {
+            auto now = clock::now();
+            int timeout_ms = -1;
+            if (deadline_ != clock::time_point::max() ||
+                wait_budget_ != clock::duration::max()) {
+                auto rest = std::min(deadline_ == clock::time_point::max()
+                                         ? clock::duration::max()
+                                         : deadline_ - now,
+                                     wait_budget_ - *waited_);
+                if (rest <= clock::duration::zero()) {
+                    timed_out_ = true;
+                    return false;
+                }
+                timeout_ms = std::min<int64_t>(
+                    std::chrono::ceil<std::chrono::milliseconds>(rest).count(),
+                    1 << 30);
+            }
+            pollfd pfd{fd_, events, 0};
+            int r = ::poll(&pfd, 1, timeout_ms);
+            *waited_ += clock::now() - now;
+            if (r > 0 || (r < 0 && errno != EINTR)) {
+                return true;
+            }
+        }
+    }
+    bool flush_out_() {
+        const char* p = pbase();
+        size_t rest = pptr() - pbase();
+        if (out_transcript_ && rest > 0) {
+            out_transcript_->write(p, rest);
+        }
+        while (rest > 0) {
+            if (timed_out_) {
+                return false;
+            }
+            ssize_t n = ::write(fd_, p, rest);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if (errno == EAGAIN && wait_(POLLOUT)) {
+                    continue;
+                }
+                return false;
+            }
+            p += n;
+            rest -= n;
+        }
+        setp(out_buf_.data(), out_buf_.data() + out_buf_.size());
+        return true;
+    }
+ protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) {
+            return traits_type::to_int_type(*gptr());
+        }
+        ssize_t n;
+        while (true) {
+            if (timed_out_) {
+                return traits_type::eof();
+            }
+            n = ::read(fd_, in_buf_.data(), in_buf_.size());
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && errno == EAGAIN && wait_(POLLIN)) {
+                continue;
+            }
+            break;
+        }
+        if (n <= 0) {
+            return traits_type::eof();
+        }
+        if (in_transcript_) {
+            in_transcript_->write(in_buf_.data(), n);
+        }
+        setg(in_buf_.data(), in_buf_.data(), in_buf_.data() + n);
+        return traits_type::to_int_type(*gptr());
+    }
+    int_type overflow(int_type c) override {
+        if (!flush_out_()) {
+            return traits_type::eof();
+        }
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+    int sync() override {
+        return flush_out_() ? 0 : -1;
+    }
+ public:
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1 << 16;
+    explicit FileDescriptorBuffer(int fd, size_t buf_size = DEFAULT_BUFFER_SIZE)
+        : fd_(fd), in_buf_(buf_size), out_buf_(buf_size) {
+        ::fcntl(fd_, F_SETFL, ::fcntl(fd_, F_GETFL) | O_NONBLOCK);
+        setg(in_buf_.data(), in_buf_.data(), in_buf_.data());
+        setp(out_buf_.data(), out_buf_.data() + out_buf_.size());
+    }
+    ~FileDescriptorBuffer() override {
+        sync();
+    }
+    void set_transcript(std::ostream* in_transcript,
+                        std::ostream* out_transcript) {
+        in_transcript_ = in_transcript;
+        out_transcript_ = out_transcript;
+    }
+    void set_deadline(clock::time_point deadline) {
+        deadline_ = deadline;
+    }
+    void set_wait_budget(clock::duration budget) {
+        wait_budget_ = budget;
+    }
+    void set_wait_counter(clock::duration* counter) {
+        waited_ = counter ? counter : &own_waited_;
+    }
+    clock::duration waited() const {
+        return *waited_;
+    }
+    bool timed_out() const {
+        return timed_out_;
+    }
+};
+class ChildProcess {
+    pid_t pid_ = -1;
+    int stdin_fd_ = -1;
+    int stdout_fd_ = -1;
+    int exit_status_ = -1;
+    static int cloexec_pipe_(int fds[2]) {
+#ifdef __linux__
+        return pipe2(fds, O_CLOEXEC);
+#else
+        if (pipe(fds) == -1) {
+            return -1;
+        }
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return 0;
+#endif
+    }
+ public:
+    ChildProcess() = default;
+    ChildProcess(const ChildProcess&) = delete;
+    ChildProcess& operator=(const ChildProcess&) = delete;
+    void spawn(const std::vector<std::string>& args,
+               const std::string& stderr_path = "/dev/null") {
+        if (pid_ != -1) {
+            throw std::logic_error("The child process is already spawned.");
+        }
+        if (args.empty()) {
+            throw std::logic_error("No command is given.");
+        }
+        int in_pipe[2], out_pipe[2];
+        if (cloexec_pipe_(in_pipe) == -1) {
+            throw std::runtime_error("Failed to create a pipe");
+        }
+        if (cloexec_pipe_(out_pipe) == -1) {
+            ::close(in_pipe[0]);
+            ::close(in_pipe[1]);
+            throw std::runtime_error("Failed to create a pipe");
+        }
+        posix_spawn_file_actions_t fa;
+        posix_spawn_file_actions_init(&fa);
+        posix_spawn_file_actions_adddup2(&fa, in_pipe[0], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&fa, out_pipe[1], STDOUT_FILENO);
+        if (!stderr_path.empty()) {
+            posix_spawn_file_actions_addopen(&fa, STDERR_FILENO,
+                                             stderr_path.c_str(),
+                                             O_WRONLY | O_CREAT | O_TRUNC,
+                                             0644);
+        }
+        std::vector<char*> argv;
+        for (const auto& a : args) {
+            argv.push_back(const_cast<char*>(a.c_str()));
+        }
+        argv.push_back(nullptr);
+        int err = posix_spawnp(&pid_, argv[0], &fa, nullptr, argv.data(),
+                               environ);
+        posix_spawn_file_actions_destroy(&fa);
+        ::close(in_pipe[0]);
+        ::close(out_pipe[1]);
+        if (err != 0) {
+            pid_ = -1;
+            ::close(in_pipe[1]);
+            ::close(out_pipe[0]);
+            throw std::runtime_error("Failed to spawn '" + args[0] +
+                                     "':" + std::strerror(err));
+        }
+        stdin_fd_ = in_pipe[1];
+        stdout_fd_ = out_pipe[0];
+    }
+    void spawn_shell(const std::string& command,
+                     const std::string& stderr_path = "/dev/null") {
+        spawn({"/bin/sh", "-c", command}, stderr_path);
+    }
+    int stdin_fd() const {
+        return stdin_fd_;
+    }
+    int stdout_fd() const {
+        return stdout_fd_;
+    }
+    void close_stdin() {
+        if (stdin_fd_ != -1) {
+            ::close(stdin_fd_);
+            stdin_fd_ = -1;
+        }
+    }
+    void close_stdout() {
+        if (stdout_fd_ != -1) {
+            ::close(stdout_fd_);
+            stdout_fd_ = -1;
+        }
+    }
+    int wait() {
+        close_stdin();
+        close_stdout();
+        if (pid_ != -1) {
+            int status;
+            while (waitpid(pid_, &status, 0) == -1 && errno == EINTR) {
+            }
+            exit_status_ = status;
+            pid_ = -1;
+        }
+        return exit_status_;
+    }
+    void kill() {
+        if (pid_ != -1) {
+            ::kill(pid_, SIGKILL);
+        }
+    }
+    ~ChildProcess() {
+        kill();
+        wait();
+    }
+};
+#endif
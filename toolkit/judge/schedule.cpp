@@ -3,8 +3,10 @@
 #include <string>
 #include "error_check.hpp"
 #include "io.hpp"
+#include "json_log.hpp"
 #include "lib/json.hpp"
 #include "logger.hpp"
+#include "snapshot.hpp"
 void to_json(json_ref j, const ScheduleAtom& a) {
     j = json{{"job_id", a.job_id}};
 }
@@ -57,22 +59,43 @@ void Schedule::set_empty_schedule(discrete_time_t crt_0b_ ,
     }
     throw_if_invalid();
 }
+void Schedule::set_job_ids(discrete_time_t crt_0b_, discrete_time_t t_max,
+                           const std::vector<job_id_t>& job_ids) {
+    set_update_time(crt_0b_);
+    t_max_ = t_max;
+    discrete_time_t len = (t_max - 1) - crt_0b_ + 1;
+    THROW_WA_IF(WrongAnswerType::SCHEDULE_JOB_NUM_MISMATCH,
+                job_ids.size() != len,
+                "Schedule length mismatch (expected:%d,given:%d)", len,
+                (int)job_ids.size());
+    elems_.clear();
+    for (auto jid : job_ids) {
+        ScheduleAtom a;
+        a.job_id = jid;
+        elems_.push_back(a);
+    }
+    throw_if_invalid();
+}
+discrete_time_t Schedule::T_max() const {
+    return t_max_;
+}
 size_t Schedule::size() const {
     return elems_.size();
 }
+CheckCode Schedule::check() const {
+    RETURN_CHECK_CODE_IF((t_max_ - 1) - update_time() + 1 != size(),
+                         SCHEDULE_LENGTH_IS_INVALID);
+    return CheckCode::OK;
+}
 bool Schedule::is_valid(std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    VALIDITY_CHECK_WITH_MSG((t_max_ - 1) - update_time() + 1 != size(), valid,
-                            msg, "Schedule length is invalid");
-    return valid;
+    return report_check(check(), msg);
 }
 void Schedule::throw_if_invalid() const {
-    std::string msg;
+    const CheckCode code = check();
     THROW_RUNTIME_ERROR_IF(
-        !is_valid(&msg),
-        "This schedule is invalid for the following reason(s):%s", msg.c_str());
+        code != CheckCode::OK,
+        "This schedule is invalid for the following reason(s):%s",
+        check_code_to_str(code));
 }
 double Schedule::calc_diff_and_apply(double init_pen, discrete_time_t crt_0b,
                                      const Schedule& sch_modify,
@@ -109,6 +132,35 @@ double Schedule::calc_execution_penalty(discrete_time_t t, job_id_t id,
     }
     return 1.0;
 }
+void Schedule::snapshot(SnapshotWriter& w) const {
+    w.write(update_time_);
+    w.write(t_max_);
+    w.write_sequence(elems_);
+}
+void Schedule::restore(SnapshotReader& r) {
+    r.read(update_time_);
+    r.read(t_max_);
+    r.read_sequence(elems_);
+}
+void Schedule::write_turn_log(JsonLogWriter& w) const {
+    w.begin_object();
+    w.key("elements");
+    w.begin_array();
+    for (const auto& a : elems_) {
+        w.begin_object();
+        w.key("job_id");
+        w.value(a.job_id);
+        w.end_object();
+    }
+    w.end_array();
+    w.key("is_valid");
+    w.value(is_valid());
+    w.key("t_max");
+    w.value(t_max_);
+    w.key("update_time");
+    w.value(update_time());
+    w.end_object();
+}
 void to_json(json_ref j, const Schedule& s) {
     j = json{
         {"t_max", s.t_max_},
@@ -5,6 +5,10 @@
 #include "defines.hpp"
 #include "error_check.hpp"
 #include "json_fwd.hpp"
+class SnapshotReader;
+class BinaryLogWriter;
+class JsonLogWriter;
+class SnapshotWriter;
 struct ScheduleAtom {
     job_id_t job_id = INVALID_JOB_ID;
     friend void to_json(json_ref j, const ScheduleAtom& e);
@@ -27,10 +31,16 @@ class Schedule {
     void read_from_stream(discrete_time_t crt_0b_, discrete_time_t t_max,
                           std::istream& is);
     void set_empty_schedule(discrete_time_t crt_0b_, discrete_time_t t_max);
+    void set_job_ids(discrete_time_t crt_0b_, discrete_time_t t_max,
+                     const std::vector<job_id_t>& job_ids);
     size_t size() const;
     discrete_time_t T_max() const;
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
     void throw_if_invalid() const;
+    void snapshot(SnapshotWriter& w) const;
+    void write_turn_log(JsonLogWriter& w) const;
+    void restore(SnapshotReader& r);
     template <class Fn>
     void for_each_in_range(discrete_time_t st, discrete_time_t en,
                            const Fn& f) const {
@@ -1,7 +1,11 @@
 #include "schedule_manager.hpp"
+#include <utility>
+#include "binary_log.hpp"
 #include "io.hpp"
+#include "json_log.hpp"
 #include "lib/json.hpp"
 #include "logger.hpp"
+#include "snapshot.hpp"
 void ScheduleManager::output_to_contestant(std::ostream& os) const {
     ValueWriter wr(os);
     output_line_to_contestant(
@@ -36,66 +40,146 @@ void ScheduleManager::read_from_stream(WorldType wt, std::istream& is) {
     THROW_RUNTIME_ERROR_IF(schedule_score_scale_ < 0.0,
                            "Schedule score scale must be >=0");
 }
+void ScheduleManager::reserve_worker_(worker_id_t id) {
+    if (id < has_schedule_.size()) {
+        return;
+    }
+    schedules_.resize(id + 1);
+    schedule_penalties_.resize(id + 1);
+    has_schedule_.resize(id + 1);
+    has_schedule_penalty_.resize(id + 1);
+}
+bool ScheduleManager::schedule_exists_(worker_id_t id) const {
+    return has_schedule_.in_range(id) && has_schedule_.test(id);
+}
+bool ScheduleManager::penalty_exists_(worker_id_t id) const {
+    return has_schedule_penalty_.in_range(id) && has_schedule_penalty_.test(id);
+}
 void ScheduleManager::accumulate_schedule_penalty(discrete_time_t crt0b,
                                                   worker_id_t wid, job_id_t id,
                                                   int amount) {
-    THROW_LOGIC_ERROR_IF(schedules_.find(wid) == schedules_.end(),
+    THROW_LOGIC_ERROR_IF(!schedule_exists_(wid),
                          "No schedule is set for worker id %d", wid);
-    if (schedule_penalties_.find(wid) == schedule_penalties_.end()) {
+    if (has_schedule_penalty_.set(wid)) {
         schedule_penalties_[wid] = 1.0;
     }
-    schedule_penalties_.at(wid) *=
-        schedules_.at(wid).calc_execution_penalty(crt0b, id, amount);
+    schedule_penalties_[wid] *=
+        schedules_[wid].calc_execution_penalty(crt0b, id, amount);
 }
 double ScheduleManager::get_schedule_penalty(worker_id_t wid0b) const {
-    return schedule_penalties_.at(wid0b);
+    THROW_LOGIC_ERROR_IF(!penalty_exists_(wid0b),
+                         "No schedule penalty for worker id %d", wid0b);
+    return schedule_penalties_[wid0b];
+}
+const Schedule& ScheduleManager::get_schedule(worker_id_t wid0b) const {
+    THROW_LOGIC_ERROR_IF(!schedule_exists_(wid0b),
+                         "No schedule is set for worker id %d", wid0b);
+    return schedules_[wid0b];
 }
 void ScheduleManager::set_new_schedule(discrete_time_t crt0b, worker_id_t id,
                                        const Schedule& s) {
     THROW_RUNTIME_ERROR_IF(id < 0,
                            "Tried to set a schedule for negative worker id");
-    if (schedule_penalties_.find(id) == schedule_penalties_.end()) {
+    reserve_worker_(id);
+    if (has_schedule_penalty_.set(id)) {
         schedule_penalties_[id] = 1.0;
     }
-    if (schedules_.find(id) == schedules_.end()) {
+    if (!has_schedule_.test(id)) {
         THROW_LOGIC_ERROR_IF(crt0b != 0,
                              "Initial schedules must be set at t=0");
         THROW_LOGIC_ERROR_IF(s.update_time() != 0,
                              "An initial schedule has non-zero beginning time");
-        schedules_.emplace(id, s);
+        schedules_[id] = s;
+        has_schedule_.set(id);
         return;
     }
-    schedule_penalties_.at(id) *= schedules_.at(id).calc_diff_and_apply(
+    schedule_penalties_[id] *= schedules_[id].calc_diff_and_apply(
         1.0, crt0b, s, schedule_penalty_coeff_, schedule_penalty_base_);
 }
 double ScheduleManager::calc_schedule_bonus_coefficient() const {
     double penalty = 1.0;
-    for (auto [wid, p] : schedule_penalties_) {
-        penalty *= get_schedule_penalty(wid);
-    }
+    has_schedule_penalty_.for_each(
+        [&](worker_id_t wid) { penalty *= schedule_penalties_[wid]; });
     INFO("Schedule penalty:%.17g", penalty);
     return 1.0 + schedule_score_scale_ * penalty;
 }
-void ScheduleManager::log_mutable_info_only(discrete_time_t crt0b,
-                                            bool e) const {
-    this->LogInfoSwitcher::log_mutable_info_only(crt0b, e);
+void ScheduleManager::snapshot(SnapshotWriter& w) const {
+    w.write<uint64_t>(has_schedule_.count());
+    has_schedule_.for_each([&](worker_id_t wid) {
+        w.write(wid);
+        schedules_[wid].snapshot(w);
+    });
+    w.write<uint64_t>(has_schedule_penalty_.count());
+    has_schedule_penalty_.for_each([&](worker_id_t wid) {
+        w.write(std::make_pair(wid, schedule_penalties_[wid]));
+    });
 }
-void to_json(json_ref j, const ScheduleManager& sm) {
-    if (sm.log_mutable_only_) {
-        std::map<worker_id_t, std::reference_wrapper<const Schedule>> sch;
-        for (auto& kv : sm.schedules_) {
-            if (kv.second.update_time() == sm.switched_time_) {
-                sch.emplace(kv.first, kv.second);
-            }
-        }
-        j = json{
-            {"updated_schedules", sch},
-            {"schedule_penalties", sm.schedule_penalties_}
-        };
-    } else {
-        j = json{
-            {"schedules", sm.schedules_},
-            {"schedule_penalties", sm.schedule_penalties_}
-        };
+void ScheduleManager::restore(SnapshotReader& r) {
+    has_schedule_.clear();
+    auto n = r.read<uint64_t>();
+    for (uint64_t i = 0; i < n; i++) {
+        auto wid = r.read<worker_id_t>();
+        THROW_RUNTIME_ERROR_IF(wid < 0, "Invalid worker id in the snapshot.");
+        reserve_worker_(wid);
+        schedules_[wid].restore(r);
+        has_schedule_.set(wid);
+    }
+    THROW_LOGIC_ERROR_IF(has_schedule_.count() != n,
+                         "Schedules of the snapshot do not match.");
+    has_schedule_penalty_.clear();
+    auto m = r.read<uint64_t>();
+    for (uint64_t i = 0; i < m; i++) {
+        auto [wid, p] = r.read<std::pair<worker_id_t, double>>();
+        THROW_RUNTIME_ERROR_IF(wid < 0, "Invalid worker id in the snapshot.");
+        reserve_worker_(wid);
+        schedule_penalties_[wid] = p;
+        has_schedule_penalty_.set(wid);
     }
 }
+void ScheduleManager::write_turn_log(discrete_time_t crt0b,
+                                     JsonLogWriter& w) const {
+    w.begin_object();
+    w.key("schedule_penalties");
+    w.begin_array();
+    has_schedule_penalty_.for_each(
+        [&](worker_id_t wid) { w.pair(wid, schedule_penalties_[wid]); });
+    w.end_array();
+    w.key("updated_schedules");
+    w.begin_array();
+    has_schedule_.for_each([&](worker_id_t wid) {
+        if (schedules_[wid].update_time() == crt0b) {
+            w.begin_array();
+            w.value(wid);
+            schedules_[wid].write_turn_log(w);
+            w.end_array();
+        }
+    });
+    w.end_array();
+    w.end_object();
+}
+void ScheduleManager::write_turn_log(discrete_time_t crt0b,
+                                     BinaryLogWriter& w) const {
+    has_schedule_penalty_.for_each([&](worker_id_t wid) {
+        w.add_schedule_penalty(schedule_penalties_[wid]);
+    });
+    has_schedule_.for_each([&](worker_id_t wid) {
+        if (schedules_[wid].update_time() == crt0b) {
+            w.add_schedule_update(wid, schedules_[wid]);
+        }
+    });
+}
+void to_json(json_ref j, const ScheduleManager& sm) {
+    json schedules = json::array();
+    sm.has_schedule_.for_each([&](worker_id_t wid) {
+        schedules.push_back(json::array({wid, sm.schedules_[wid]}));
+    });
+    json schedule_penalties = json::array();
+    sm.has_schedule_penalty_.for_each([&](worker_id_t wid) {
+        schedule_penalties.push_back(
+            json::array({wid, sm.schedule_penalties_[wid]}));
+    });
+    j = json{
+        {"schedules", std::move(schedules)},
+        {"schedule_penalties", std::move(schedule_penalties)}
+    };
+}
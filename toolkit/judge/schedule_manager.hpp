@@ -1,27 +1,37 @@
 #ifndef HEADER_2HC2022_SCHEDULE_MANAGER
 #define HEADER_2HC2022_SCHEDULE_MANAGER 
-#include <map>
+#include <vector>
 #include "defines.hpp"
+#include "id_bitset.hpp"
 #include "io.hpp"
 #include "schedule.hpp"
-class ScheduleManager : public LogInfoSwitcher {
-    std::map<worker_id_t, Schedule> schedules_;
-    std::map<worker_id_t, double> schedule_penalties_;
+class ScheduleManager {
+    std::vector<Schedule> schedules_;
+    std::vector<double> schedule_penalties_;
+    IdBitset has_schedule_;
+    IdBitset has_schedule_penalty_;
+    void reserve_worker_(worker_id_t id);
+    bool schedule_exists_(worker_id_t id) const;
+    bool penalty_exists_(worker_id_t id) const;
     double schedule_penalty_base_ = INVALID_REAL;
     double schedule_penalty_coeff_ = INVALID_REAL;
     double schedule_score_scale_ = INVALID_REAL;
  public:
-    void log_mutable_info_only(discrete_time_t crt0b, bool e) const override;
     double schedule_penalty_base() const;
     double schedule_penalty_coeff() const;
     void accumulate_schedule_penalty(discrete_time_t crt0b, worker_id_t wid,
                                      job_id_t jid, int amount);
     double get_schedule_penalty(worker_id_t wid0b) const;
+    const Schedule& get_schedule(worker_id_t wid0b) const;
     void set_new_schedule(discrete_time_t crt0b, worker_id_t id,
                           const Schedule& s);
     void read_from_stream(WorldType wt, std::istream& is);
     void output_to_contestant(std::ostream& os) const;
     double calc_schedule_bonus_coefficient() const;
+    void snapshot(SnapshotWriter& w) const;
+    void write_turn_log(discrete_time_t crt0b, JsonLogWriter& w) const;
+    void write_turn_log(discrete_time_t crt0b, BinaryLogWriter& w) const;
+    void restore(SnapshotReader& r);
     friend void to_json(json_ref j, const ScheduleManager& sm);
 };
 #endif
@@ -1,45 +1,98 @@
 #include "score.hpp"
+#include <algorithm>
 #include <string>
+#include <utility>
+#include "binary_log.hpp"
+#include "error_check.hpp"
+#include "json_log.hpp"
 #include "lib/json.hpp"
+#include "snapshot.hpp"
 void ScoreManager::initialize() {
-    score_ = static_cast<score_t>(0);
+    score_ = ExactScore();
     score_jobwise_.clear();
+    has_score_jobwise_.assign(0);
 }
-float_score_t ScoreManager::score() const {
+const ExactScore& ScoreManager::exact_score() const {
     return score_;
 }
-void ScoreManager::add_score_jobwise(job_id_t id, float_score_t s) {
-    if (score_jobwise_[id] == INVALID_FLOAT_SCORE) {
-        throw std::logic_error("Jobwise Score is invalid");
+float_score_t ScoreManager::score() const {
+    return score_.to_float_score();
+}
+void ScoreManager::add_score_jobwise(job_id_t id, const ExactScore& s) {
+    THROW_LOGIC_ERROR_IF(id < 0, "Job ID is negative (internal).");
+    if (id >= has_score_jobwise_.size()) {
+        const int n = std::max<int>(id + 1, 2 * score_jobwise_.size());
+        score_jobwise_.resize(n);
+        has_score_jobwise_.resize(n);
+    }
+    if (has_score_jobwise_.set(id)) {
+        score_jobwise_[id] = ExactScore();
     }
     score_jobwise_[id] += s;
 }
 void ScoreManager::join_jobwise_score(job_id_t id) {
-    if (score_jobwise_[id] == INVALID_FLOAT_SCORE) {
-        throw std::logic_error("Jobwise Score is invalid");
-    }
-    if (score_ == INVALID_FLOAT_SCORE) {
-        throw std::logic_error("Total score is invalid");
+    if (!has_score_jobwise_.in_range(id) || !has_score_jobwise_.test(id)) {
+        return;
     }
     score_ += score_jobwise_[id];
-    score_jobwise_.erase(id);
+    has_score_jobwise_.reset(id);
 }
-void ScoreManager::set_score(float_score_t s) {
-    if (score_ == INVALID_FLOAT_SCORE) {
-        throw std::logic_error("Score is invalid(set_score)");
-    }
-    if (s == INVALID_FLOAT_SCORE) {
-        throw std::logic_error("Tried to set invalid score");
-    }
+void ScoreManager::set_score(const ExactScore& s) {
     score_ = s;
 }
+void ScoreManager::snapshot(SnapshotWriter& w) const {
+    score_.snapshot(w);
+    w.write<uint64_t>(has_score_jobwise_.count());
+    has_score_jobwise_.for_each([&](job_id_t id) {
+        w.write(id);
+        score_jobwise_[id].snapshot(w);
+    });
+}
+void ScoreManager::restore(SnapshotReader& r) {
+    score_.restore(r);
+    has_score_jobwise_.clear();
+    auto n = r.read<uint64_t>();
+    for (uint64_t i = 0; i < n; i++) {
+        auto id = r.read<job_id_t>();
+        ExactScore s;
+        s.restore(r);
+        add_score_jobwise(id, s);
+    }
+}
+void ScoreManager::write_turn_log(BinaryLogWriter& w) const {
+    float_score_t sum = 0.0;
+    has_score_jobwise_.for_each([&](job_id_t id) {
+        const float_score_t s = score_jobwise_[id].to_float_score();
+        w.add_jobwise_score(id, s);
+        sum += s;
+    });
+    w.set_score(score(), sum);
+}
+void ScoreManager::write_turn_log(JsonLogWriter& w) const {
+    float_score_t sum = 0.0;
+    w.begin_object();
+    w.key("score");
+    w.value(score().str());
+    w.key("score_jobwise");
+    w.begin_array();
+    has_score_jobwise_.for_each([&](job_id_t id) {
+        const float_score_t s = score_jobwise_[id].to_float_score();
+        w.pair(id, s.str());
+        sum += s;
+    });
+    w.end_array();
+    w.key("score_jobwise_sum");
+    w.value(sum.str());
+    w.end_object();
+}
 void to_json(json_ref j, const ScoreManager& sm) {
-    std::unordered_map<job_id_t, std::string> score_jobwise_str;
+    json score_jobwise_str = json::array();
     float_score_t sum = 0.0;
-    for (const auto& kv : sm.score_jobwise_) {
-        score_jobwise_str[kv.first] = kv.second.str();
-        sum += kv.second;
-    }
+    sm.has_score_jobwise_.for_each([&](job_id_t id) {
+        const float_score_t s = sm.score_jobwise_[id].to_float_score();
+        score_jobwise_str.push_back(json::array({id, s.str()}));
+        sum += s;
+    });
     j = json{{"score", sm.score().str()},
              {"score_jobwise", score_jobwise_str},
              {"score_jobwise_sum", sum.str()}};
@@ -1,17 +1,29 @@
 #ifndef HEADER_2HC2022_SCORE
 #define HEADER_2HC2022_SCORE 
-#include <unordered_map>
+#include <vector>
 #include "defines.hpp"
+#include "exact_score.hpp"
+#include "id_bitset.hpp"
 #include "json_fwd.hpp"
+class SnapshotReader;
+class BinaryLogWriter;
+class JsonLogWriter;
+class SnapshotWriter;
 class ScoreManager {
-    float_score_t score_ = INVALID_FLOAT_SCORE;
-    std::unordered_map<job_id_t, float_score_t> score_jobwise_;
+    ExactScore score_;
+    std::vector<ExactScore> score_jobwise_;
+    IdBitset has_score_jobwise_;
  public:
     void initialize();
+    const ExactScore& exact_score() const;
     float_score_t score() const;
-    void add_score_jobwise(job_id_t id, float_score_t s);
+    void add_score_jobwise(job_id_t id, const ExactScore& s);
     void join_jobwise_score(job_id_t id);
-    void set_score(float_score_t s);
+    void set_score(const ExactScore& s);
+    void snapshot(SnapshotWriter& w) const;
+    void write_turn_log(JsonLogWriter& w) const;
+    void write_turn_log(BinaryLogWriter& w) const;
+    void restore(SnapshotReader& r);
     friend void to_json(json_ref j, const ScoreManager& sm);
 };
 #endif
@@ -0,0 +1,193 @@
+#include "seekable_log.hpp"
+#include <cstring>
+#include <utility>
+#include "error_check.hpp"
+#include "world.hpp"
+static void read_turn_record_(
+    SnapshotReader& r, world_snapshot_t& keyframe,
+    std::vector<std::pair<worker_id_t, Schedule>>& changes,
+    std::vector<action::ActionRecord>& actions) {
+    const bool has_keyframe = r.read<uint8_t>();
+    if (has_keyframe) {
+        r.read_sequence(keyframe);
+    } else {
+        keyframe.clear();
+    }
+    changes.resize(r.read<uint64_t>());
+    for (auto& [wid, s] : changes) {
+        r.read(wid);
+        s.restore(r);
+    }
+    r.read_sequence(actions);
+}
+SeekableLogWriter::SeekableLogWriter(std::ostream& os, int keyframe_interval)
+    : os_(os), keyframe_interval_(keyframe_interval) {
+    THROW_LOGIC_ERROR_IF(keyframe_interval_ <= 0,
+                         "Keyframe interval must be positive.");
+}
+void SeekableLogWriter::flush_buf_() {
+    os_.write(buf_.data(), buf_.size());
+    written_ += buf_.size();
+    buf_.clear();
+}
+void SeekableLogWriter::begin_turns(const World& world) {
+    SnapshotWriter w(buf_);
+    w.write_bytes(SEEKABLE_LOG_MAGIC, sizeof(SEEKABLE_LOG_MAGIC));
+    w.write(SEEKABLE_LOG_VERSION);
+    w.write(world.world_type());
+    w.write(world.T_MAX());
+    w.write(keyframe_interval_);
+    std::vector<job_id_t> accepted;
+    world.job_manager.for_each_accepted_job(
+        [&](job_id_t id) { accepted.push_back(id); });
+    w.write_sequence(accepted);
+    flush_buf_();
+    world.snapshot(keyframe_);
+    has_keyframe_ = true;
+}
+void SeekableLogWriter::end_turn(const World& world, discrete_time_t t_0b) {
+    THROW_LOGIC_ERROR_IF(t_0b != static_cast<discrete_time_t>(offsets_.size()),
+                         "Turns must be logged in order.");
+    offsets_.push_back(written_);
+    SnapshotWriter w(buf_);
+    w.write<uint8_t>(has_keyframe_);
+    if (has_keyframe_) {
+        w.write_sequence(keyframe_);
+        has_keyframe_ = false;
+    }
+    std::vector<worker_id_t> changed;
+    std::vector<action::ActionRecord> actions;
+    world.worker_manager.for_each_worker([&](worker_id_t wid) {
+        if (world.world_type() == WorldType::B &&
+            world.schedule_manager.get_schedule(wid).update_time() == t_0b) {
+            changed.push_back(wid);
+        }
+        actions.push_back(world.worker_manager.workers(wid).last_action());
+    });
+    w.write<uint64_t>(changed.size());
+    for (worker_id_t wid : changed) {
+        w.write(wid);
+        world.schedule_manager.get_schedule(wid).snapshot(w);
+    }
+    w.write_sequence(actions);
+    flush_buf_();
+    if ((t_0b + 1) % keyframe_interval_ == 0 && t_0b + 1 < world.T_MAX()) {
+        world.snapshot(keyframe_);
+        has_keyframe_ = true;
+    }
+}
+void SeekableLogWriter::end_session() {
+    offsets_.push_back(written_);
+    SnapshotWriter w(buf_);
+    w.write_sequence(offsets_);
+    w.write(written_);
+    w.write_bytes(SEEKABLE_LOG_MAGIC, sizeof(SEEKABLE_LOG_MAGIC));
+    flush_buf_();
+    os_.flush();
+    THROW_RUNTIME_ERROR_IF(!os_, "Failed to write the seekable log.");
+}
+SeekableLog::SeekableLog(const std::string& path)
+    : ifs_(path, std::ios::binary) {
+    THROW_RUNTIME_ERROR_IF(!ifs_, "Failed to open the file:%s", path.c_str());
+    const uint64_t trailer_size = sizeof(uint64_t) + sizeof(SEEKABLE_LOG_MAGIC);
+    ifs_.seekg(0, std::ios::end);
+    const uint64_t file_size = ifs_.tellg();
+    THROW_RUNTIME_ERROR_IF(file_size < trailer_size,
+                           "Not a seekable log:%s", path.c_str());
+    read_range_(file_size - trailer_size, file_size);
+    uint64_t footer_offset;
+    {
+        SnapshotReader r(buf_);
+        r.read(footer_offset);
+        THROW_RUNTIME_ERROR_IF(
+            std::memcmp(buf_.data() + sizeof(uint64_t), SEEKABLE_LOG_MAGIC,
+                        sizeof(SEEKABLE_LOG_MAGIC)) != 0 ||
+                footer_offset > file_size - trailer_size,
+            "Not a seekable log:%s", path.c_str());
+    }
+    read_range_(footer_offset, file_size - trailer_size);
+    {
+        SnapshotReader r(buf_);
+        r.read_sequence(offsets_);
+        THROW_RUNTIME_ERROR_IF(!r.at_end(), "Broken index in the seekable log.");
+    }
+    THROW_RUNTIME_ERROR_IF(offsets_.empty() || offsets_.back() != footer_offset,
+                           "Broken index in the seekable log.");
+    for (size_t i = 0; i + 1 < offsets_.size(); i++) {
+        THROW_RUNTIME_ERROR_IF(offsets_[i] > offsets_[i + 1],
+                               "Broken index in the seekable log.");
+    }
+    read_range_(0, offsets_[0]);
+    SnapshotReader r(buf_);
+    char magic[sizeof(SEEKABLE_LOG_MAGIC)];
+    r.read_bytes(magic, sizeof(magic));
+    THROW_RUNTIME_ERROR_IF(
+        std::memcmp(magic, SEEKABLE_LOG_MAGIC, sizeof(magic)) != 0,
+        "Not a seekable log:%s", path.c_str());
+    THROW_RUNTIME_ERROR_IF(r.read<uint32_t>() != SEEKABLE_LOG_VERSION,
+                           "Unsupported seekable log version.");
+    r.read(type_);
+    r.read(t_max_);
+    r.read(keyframe_interval_);
+    r.read_sequence(accepted_jobs_);
+    THROW_RUNTIME_ERROR_IF(
+        keyframe_interval_ <= 0 || t_max_ < 0 ||
+            offsets_.size() != static_cast<size_t>(t_max_) + 1,
+        "Broken header in the seekable log.");
+}
+void SeekableLog::read_range_(uint64_t begin, uint64_t end) {
+    buf_.resize(end - begin);
+    ifs_.clear();
+    ifs_.seekg(begin);
+    ifs_.read(buf_.data(), buf_.size());
+    THROW_RUNTIME_ERROR_IF(!ifs_, "The seekable log is truncated.");
+}
+WorldType SeekableLog::world_type() const {
+    return type_;
+}
+discrete_time_t SeekableLog::T_MAX() const {
+    return t_max_;
+}
+int SeekableLog::keyframe_interval() const {
+    return keyframe_interval_;
+}
+void SeekableLog::begin(World& world) const {
+    THROW_LOGIC_ERROR_IF(world.world_type() != type_ || world.T_MAX() != t_max_,
+                         "The seekable log was recorded in another world.");
+    world.begin_session();
+    if (type_ == WorldType::B) {
+        world.accept_jobs(accepted_jobs_);
+    }
+    world.begin_turns();
+}
+void SeekableLog::seek(World& world, discrete_time_t t_0b) {
+    THROW_LOGIC_ERROR_IF(t_0b < 0 || t_0b >= t_max_, "turn is out of range");
+    const discrete_time_t key_t = t_0b - t_0b % keyframe_interval_;
+    std::vector<std::pair<worker_id_t, Schedule>> changes;
+    std::vector<action::ActionRecord> actions;
+    world_snapshot_t keyframe;
+    // Keyframes hold no histories; extend them up to the keyframe first.
+    const discrete_time_t logged = world.worker_manager.history_length();
+    if (logged < key_t) {
+        read_range_(offsets_[logged], offsets_[key_t]);
+        SnapshotReader r(buf_);
+        for (discrete_time_t t = logged; t < key_t; t++) {
+            read_turn_record_(r, keyframe, changes, actions);
+            world.worker_manager.replay_history(t, actions);
+        }
+    }
+    read_range_(offsets_[key_t], offsets_[t_0b + 1]);
+    SnapshotReader r(buf_);
+    for (discrete_time_t t = key_t; t <= t_0b; t++) {
+        read_turn_record_(r, keyframe, changes, actions);
+        if (t == key_t) {
+            THROW_RUNTIME_ERROR_IF(keyframe.empty(),
+                                   "Keyframe of turn %d is missing.", t);
+            world.restore(keyframe);
+        }
+        world.update_turn(t);
+        world.submit_schedule_changes(t, changes);
+        world.submit_actions(t, actions);
+        world.end_turn(t);
+    }
+}
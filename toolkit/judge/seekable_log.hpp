@@ -0,0 +1,45 @@
+#ifndef HEADER_2HC2022_SEEKABLE_LOG
+#define HEADER_2HC2022_SEEKABLE_LOG 
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "defines.hpp"
+#include "snapshot.hpp"
+class World;
+constexpr char SEEKABLE_LOG_MAGIC[8] = {'H', 'C', '2', '2', 'S', 'E', 'E', 'K'};
+constexpr uint32_t SEEKABLE_LOG_VERSION = 6;
+constexpr int DEFAULT_KEYFRAME_INTERVAL = 50;
+class SeekableLogWriter {
+    std::ostream& os_;
+    int keyframe_interval_;
+    uint64_t written_ = 0;
+    std::vector<uint64_t> offsets_;
+    world_snapshot_t buf_;
+    world_snapshot_t keyframe_;
+    bool has_keyframe_ = false;
+    void flush_buf_();
+ public:
+    SeekableLogWriter(std::ostream& os, int keyframe_interval);
+    void begin_turns(const World& world);
+    void end_turn(const World& world, discrete_time_t t_0b);
+    void end_session();
+};
+class SeekableLog {
+    std::ifstream ifs_;
+    WorldType type_ = WorldType::INVALID;
+    discrete_time_t t_max_ = INVALID_TIME;
+    int keyframe_interval_ = 0;
+    std::vector<job_id_t> accepted_jobs_;
+    std::vector<uint64_t> offsets_;
+    world_snapshot_t buf_;
+    void read_range_(uint64_t begin, uint64_t end);
+ public:
+    explicit SeekableLog(const std::string& path);
+    WorldType world_type() const;
+    discrete_time_t T_MAX() const;
+    int keyframe_interval() const;
+    void begin(World& world) const;
+    void seek(World& world, discrete_time_t t_0b);
+};
+#endif
@@ -0,0 +1,118 @@
+#ifndef HEADER_2HC2022_SNAPSHOT
+#define HEADER_2HC2022_SNAPSHOT 
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "defines.hpp"
+#include "error_check.hpp"
+using world_snapshot_t = std::vector<char>;
+template <class T> struct snapshot_element_ {
+    using type = T;
+};
+template <class K, class V> struct snapshot_element_<std::pair<const K, V>> {
+    using type = std::pair<K, V>;
+};
+template <class C>
+using snapshot_element_t_ =
+    typename snapshot_element_<typename C::value_type>::type;
+class SnapshotWriter {
+    world_snapshot_t& buf_;
+ public:
+    explicit SnapshotWriter(world_snapshot_t& buf) : buf_(buf) {
+    }
+    void write_bytes(const void* p, size_t n) {
+        const char* c = static_cast<const char*>(p);
+        buf_.insert(buf_.end(), c, c + n);
+    }
+    template <class T> void write(const T& v) {
+        if constexpr (std::is_same_v<T, float_score_t>) {
+            const auto& b = v.backend();
+            write(b.exponent());
+            write(b.sign());
+            uint8_t n = b.bits().size();
+            write(n);
+            write_bytes(b.bits().limbs(), n * sizeof(*b.bits().limbs()));
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>,
+                          "Only trivially copyable values can be written "
+                          "into a snapshot as they are.");
+            write_bytes(&v, sizeof(T));
+        }
+    }
+    template <class K, class V> void write(const std::pair<K, V>& v) {
+        write(v.first);
+        write(v.second);
+    }
+    template <class C> void write_sequence(const C& c) {
+        write<uint64_t>(c.size());
+        if constexpr (std::is_trivially_copyable_v<typename C::value_type> &&
+                      std::is_same_v<C, std::vector<typename C::value_type>>) {
+            write_bytes(c.data(), c.size() * sizeof(typename C::value_type));
+        } else {
+            for (const auto& e : c) {
+                write(e);
+            }
+        }
+    }
+};
+class SnapshotReader {
+    const world_snapshot_t& buf_;
+    size_t pos_ = 0;
+ public:
+    explicit SnapshotReader(const world_snapshot_t& buf) : buf_(buf) {
+    }
+    bool at_end() const {
+        return pos_ == buf_.size();
+    }
+    void read_bytes(void* p, size_t n) {
+        THROW_RUNTIME_ERROR_IF(buf_.size() - pos_ < n,
+                               "The snapshot is truncated.");
+        std::memcpy(p, buf_.data() + pos_, n);
+        pos_ += n;
+    }
+    template <class T> void read(T& v) {
+        if constexpr (std::is_same_v<T, float_score_t>) {
+            auto& b = v.backend();
+            read(b.exponent());
+            read(b.sign());
+            uint8_t n = read<uint8_t>();
+            b.bits().resize(n, n);
+            THROW_RUNTIME_ERROR_IF(b.bits().size() != n,
+                                   "Invalid score value in the snapshot.");
+            read_bytes(b.bits().limbs(), n * sizeof(*b.bits().limbs()));
+        } else {
+            static_assert(std::is_trivially_copyable_v<T>,
+                          "Only trivially copyable values can be read "
+                          "from a snapshot as they are.");
+            read_bytes(&v, sizeof(T));
+        }
+    }
+    template <class K, class V> void read(std::pair<K, V>& v) {
+        read(v.first);
+        read(v.second);
+    }
+    template <class T> T read() {
+        T v;
+        read(v);
+        return v;
+    }
+    template <class C> void read_sequence(C& c) {
+        using E = snapshot_element_t_<C>;
+        auto n = read<uint64_t>();
+        THROW_RUNTIME_ERROR_IF(n > buf_.size() - pos_,
+                               "The snapshot is truncated.");
+        if constexpr (std::is_trivially_copyable_v<E> &&
+                      std::is_same_v<C, std::vector<E>>) {
+            c.resize(n);
+            read_bytes(c.data(), n * sizeof(E));
+        } else {
+            c.clear();
+            for (uint64_t i = 0; i < n; i++) {
+                c.insert(c.end(), read<E>());
+            }
+        }
+    }
+};
+#endif
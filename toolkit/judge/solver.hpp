@@ -0,0 +1,102 @@
+#ifndef HEADER_2HC2022_SOLVER
+#define HEADER_2HC2022_SOLVER 
+#include <dlfcn.h>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "action.hpp"
+#include "defines.hpp"
+#include "graph.hpp"
+#include "schedule.hpp"
+#include "weather.hpp"
+class World;
+struct TurnObservation {
+    discrete_time_t time = INVALID_TIME;
+    weather_value_t weather = -1;
+    std::vector<std::pair<job_id_t, int>> relevant_job_task_rest;
+    std::vector<job_id_t> newly_ready_jobs;
+    std::vector<Position> worker_positions;
+    bool forecast_updated = false;
+    // forecast[k]: weather probabilities at time + k * division length.
+    std::vector<std::vector<double>> forecast;
+};
+struct TurnDecision {
+    std::vector<std::pair<worker_id_t, Schedule>> schedule_changes;
+    std::vector<action::Action> actions;
+    void clear() {
+        schedule_changes.clear();
+        actions.clear();
+    }
+};
+class Solver {
+ public:
+    virtual ~Solver() = default;
+    virtual void initialize(const World& world) {
+    }
+    virtual std::vector<job_id_t> select_jobs(const World& world) = 0;
+    virtual void decide(const World& world, const TurnObservation& obs,
+                        TurnDecision& decision) = 0;
+    virtual void finalize(const World& world, final_result_t score) {
+    }
+};
+#define HC2022_CREATE_SOLVER_SYMBOL "hc2022_create_solver"
+#define HC2022_DESTROY_SOLVER_SYMBOL "hc2022_destroy_solver"
+#define HC2022_EXPORT_SOLVER(solver_class) \
+    extern "C" Solver* hc2022_create_solver() { \
+        return new solver_class(); \
+    } \
+    extern "C" void hc2022_destroy_solver(Solver* s) { \
+        delete s; \
+    } \
+    struct __xd
+class SolverLibrary {
+    using create_fn_t_ = Solver* (*)();
+    using destroy_fn_t_ = void (*)(Solver*);
+    void* handle_ = nullptr;
+    create_fn_t_ create_ = nullptr;
+    destroy_fn_t_ destroy_ = nullptr;
+ public:
+    SolverLibrary() = default;
+    SolverLibrary(const SolverLibrary&) = delete;
+    SolverLibrary& operator=(const SolverLibrary&) = delete;
+    void open(const std::string& path) {
+        if (handle_ != nullptr) {
+            throw std::logic_error("Solver library is already opened.");
+        }
+        handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle_ == nullptr) {
+            throw std::runtime_error("Failed to open solver library:" +
+                                     std::string(dlerror()));
+        }
+        create_ = reinterpret_cast<create_fn_t_>(
+            dlsym(handle_, HC2022_CREATE_SOLVER_SYMBOL));
+        destroy_ = reinterpret_cast<destroy_fn_t_>(
+            dlsym(handle_, HC2022_DESTROY_SOLVER_SYMBOL));
+        if (create_ == nullptr || destroy_ == nullptr) {
+            close();
+            throw std::runtime_error(
+                "Solver library does not export " HC2022_CREATE_SOLVER_SYMBOL
+                "/" HC2022_DESTROY_SOLVER_SYMBOL
+                " (use HC2022_EXPORT_SOLVER)");
+        }
+    }
+    std::unique_ptr<Solver, destroy_fn_t_> create() const {
+        if (handle_ == nullptr) {
+            throw std::logic_error("Solver library is not opened yet.");
+        }
+        return std::unique_ptr<Solver, destroy_fn_t_>(create_(), destroy_);
+    }
+    void close() {
+        if (handle_ != nullptr) {
+            dlclose(handle_);
+            handle_ = nullptr;
+            create_ = nullptr;
+            destroy_ = nullptr;
+        }
+    }
+    ~SolverLibrary() {
+        close();
+    }
+};
+#endif
@@ -0,0 +1,121 @@
+#include "solver_process.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <istream>
+#include <ostream>
+#include "error_check.hpp"
+#include "turn_profiler.hpp"
+namespace {
+std::chrono::nanoseconds from_ms_(double ms) {
+    return std::chrono::nanoseconds(static_cast<int64_t>(ms * 1e6));
+}
+}
+SolverProcess::SolverProcess(const std::string& command,
+                             const std::string& stderr_path) {
+    child_.spawn_shell(command, stderr_path);
+    to_solver_ = std::make_unique<FileDescriptorBuffer>(child_.stdin_fd());
+    from_solver_ = std::make_unique<FileDescriptorBuffer>(child_.stdout_fd());
+    to_solver_->set_wait_counter(&waited_);
+    from_solver_->set_wait_counter(&waited_);
+}
+SolverProcess::~SolverProcess() {
+    child_.kill();
+}
+void SolverProcess::set_time_limit(const SolverTimeLimit& limit) {
+    THROW_LOGIC_ERROR_IF(limit.turn_ms < 0 || limit.total_ms < 0,
+                         "Time limits must not be negative.");
+    limit_ = limit;
+    const auto budget = limit_.total_ms > 0 ? from_ms_(limit_.total_ms)
+                                            : clock::duration::max();
+    to_solver_->set_wait_budget(budget);
+    from_solver_->set_wait_budget(budget);
+}
+void SolverProcess::set_transcript(std::ostream* input_transcript,
+                                   std::ostream* output_transcript) {
+    to_solver_->set_transcript(nullptr, input_transcript);
+    from_solver_->set_transcript(output_transcript, nullptr);
+}
+final_result_t SolverProcess::run(World& world) {
+    std::ostream os(to_solver_.get());
+    std::istream is(from_solver_.get());
+    world.set_interaction_listener(this);
+    current_turn_ = INVALID_TIME;
+    if (limit_.turn_ms > 0) {
+        const auto deadline = clock::now() + from_ms_(limit_.turn_ms);
+        to_solver_->set_deadline(deadline);
+        from_solver_->set_deadline(deadline);
+    }
+    final_result_t score;
+    try {
+        score = world.interact(is, os);
+    } catch (...) {
+        world.set_interaction_listener(nullptr);
+        if (!timed_out()) {
+            throw;
+        }
+        child_.kill();
+        THROW_WA_IF(WrongAnswerType::TIME_LIMIT_EXCEEDED,
+                    limit_.total_ms > 0 &&
+                        waited_ns() >= from_ms_(limit_.total_ms).count(),
+                    "Total time limit (%.1f ms) exceeded", limit_.total_ms);
+        THROW_WA_IF(WrongAnswerType::TIME_LIMIT_EXCEEDED,
+                    current_turn_ == INVALID_TIME,
+                    "Turn time limit (%.1f ms) exceeded before turn 1",
+                    limit_.turn_ms);
+        THROW_WA_IF(WrongAnswerType::TIME_LIMIT_EXCEEDED, true,
+                    "Turn time limit (%.1f ms) exceeded at turn %d",
+                    limit_.turn_ms, to_1b(current_turn_));
+    }
+    world.set_interaction_listener(nullptr);
+    os.flush();
+    child_.wait();
+    return score;
+}
+bool SolverProcess::timed_out() const {
+    return to_solver_->timed_out() || from_solver_->timed_out();
+}
+void SolverProcess::begin_turn_input(discrete_time_t t_0b) {
+    current_turn_ = t_0b;
+    turn_begin_ = clock::now();
+    if (limit_.turn_ms > 0) {
+        from_solver_->set_deadline(turn_begin_ + from_ms_(limit_.turn_ms));
+        to_solver_->set_deadline(clock::time_point::max());
+    }
+}
+void SolverProcess::end_turn_input(discrete_time_t t_0b) {
+    think_time_ns_.push_back(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() -
+                                                             turn_begin_)
+            .count());
+    if (limit_.turn_ms > 0) {
+        to_solver_->set_deadline(clock::now() + from_ms_(limit_.turn_ms));
+    }
+}
+const std::vector<int64_t>& SolverProcess::think_time_ns() const {
+    return think_time_ns_;
+}
+std::vector<int64_t> SolverProcess::sorted_think_time_ns() const {
+    auto ret = think_time_ns_;
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+int64_t SolverProcess::waited_ns() const {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(waited_)
+        .count();
+}
+void SolverProcess::write_report(std::ostream& os) const {
+    auto sorted = sorted_think_time_ns();
+    auto max_it = std::max_element(think_time_ns_.begin(), think_time_ns_.end());
+    char buf[256];
+    std::snprintf(
+        buf, sizeof(buf),
+        "Solver think time: %zu turns, waited %.3f ms in total, "
+        "p50 %.3f ms, p99 %.3f ms, max %.3f ms (turn %d)\n",
+        sorted.size(), waited_ns() * 1e-6, nearest_rank(sorted, 50) * 1e-6,
+        nearest_rank(sorted, 99) * 1e-6,
+        sorted.empty() ? 0.0 : sorted.back() * 1e-6,
+        sorted.empty() ? 0
+                       : static_cast<int>(max_it - think_time_ns_.begin()) + 1);
+    os << buf;
+    os.flush();
+}
@@ -0,0 +1,43 @@
+#ifndef HEADER_2HC2022_SOLVER_PROCESS
+#define HEADER_2HC2022_SOLVER_PROCESS 
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include "defines.hpp"
+#include "process.hpp"
+#include "world.hpp"
+struct SolverTimeLimit {
+    double turn_ms = 0.0;
+    double total_ms = 0.0;
+};
+class SolverProcess : public InteractionListener {
+    using clock = FileDescriptorBuffer::clock;
+    clock::duration waited_ = clock::duration::zero();
+    ChildProcess child_;
+    std::unique_ptr<FileDescriptorBuffer> to_solver_;
+    std::unique_ptr<FileDescriptorBuffer> from_solver_;
+    SolverTimeLimit limit_;
+    discrete_time_t current_turn_ = INVALID_TIME;
+    clock::time_point turn_begin_;
+    std::vector<int64_t> think_time_ns_;
+ public:
+    explicit SolverProcess(const std::string& command,
+                           const std::string& stderr_path = "");
+    SolverProcess(const SolverProcess&) = delete;
+    SolverProcess& operator=(const SolverProcess&) = delete;
+    ~SolverProcess() override;
+    void set_time_limit(const SolverTimeLimit& limit);
+    void set_transcript(std::ostream* input_transcript,
+                        std::ostream* output_transcript);
+    final_result_t run(World& world);
+    bool timed_out() const;
+    void begin_turn_input(discrete_time_t t_0b) override;
+    void end_turn_input(discrete_time_t t_0b) override;
+    const std::vector<int64_t>& think_time_ns() const;
+    std::vector<int64_t> sorted_think_time_ns() const;
+    int64_t waited_ns() const;
+    void write_report(std::ostream& os) const;
+};
+#endif
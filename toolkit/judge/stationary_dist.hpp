@@ -0,0 +1,87 @@
+#ifndef HEADER_2HC2022_STATIONARY_DIST
+#define HEADER_2HC2022_STATIONARY_DIST 
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include "lib/Eigen/Core"
+#include "lib/Eigen/LU"
+// Stationary distribution pi (pi P = pi, sum(pi) = 1) of a row-major n x n
+// transition matrix whose rows need not be normalized.
+// Solves (P^T - I) pi = 0 by GTH state reduction (Gaussian elimination with
+// off-diagonal row sums as pivots, free of cancellation). Elimination stays
+// within the bandwidth r of the matrix, so it costs O(n r^2). Reducible
+// chains fall back to a dense solve with one row replaced by sum(pi) = 1.
+inline std::vector<double> stationary_distribution(std::vector<double> p,
+                                                   int n) {
+    int band = 0;
+    for (int i = 0; i < n; i++) {
+        double sum = 0.0;
+        for (int j = 0; j < n; j++) {
+            if (p[i * n + j] != 0.0) {
+                band = std::max(band, std::abs(i - j));
+            }
+            sum += p[i * n + j];
+        }
+        for (int j = 0; j < n; j++) {
+            p[i * n + j] /= sum;
+        }
+    }
+    const std::vector<double> normalized = p;
+    std::vector<double> outflow(n);
+    bool reducible = false;
+    for (int k = n - 1; k > 0 && !reducible; k--) {
+        const int lo = std::max(0, k - band);
+        double s = 0.0;
+        for (int j = lo; j < k; j++) {
+            s += p[k * n + j];
+        }
+        if (!(s > 0.0)) {
+            reducible = true;
+            break;
+        }
+        outflow[k] = s;
+        for (int i = lo; i < k; i++) {
+            const double f = p[i * n + k] / s;
+            if (f == 0.0) {
+                continue;
+            }
+            for (int j = lo; j < k; j++) {
+                p[i * n + j] += f * p[k * n + j];
+            }
+        }
+    }
+    std::vector<double> pi(n);
+    if (!reducible) {
+        pi[0] = 1.0;
+        for (int k = 1; k < n; k++) {
+            double v = 0.0;
+            for (int i = std::max(0, k - band); i < k; i++) {
+                v += pi[i] * p[i * n + k];
+            }
+            pi[k] = v / outflow[k];
+        }
+    } else {
+        using RowMajorMatrixXd =
+            Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic,
+                          Eigen::RowMajor>;
+        Eigen::Map<const RowMajorMatrixXd> mat(normalized.data(), n, n);
+        Eigen::MatrixXd a = mat.transpose();
+        a -= Eigen::MatrixXd::Identity(n, n);
+        a.row(n - 1).setOnes();
+        Eigen::VectorXd b = Eigen::VectorXd::Zero(n);
+        b[n - 1] = 1.0;
+        Eigen::VectorXd x = a.fullPivLu().solve(b);
+        for (int i = 0; i < n; i++) {
+            pi[i] = std::max(0.0, x[i]);
+        }
+    }
+    double sum = 0.0;
+    for (double v : pi) {
+        sum += v;
+    }
+    for (double& v : pi) {
+        v /= sum;
+    }
+    return pi;
+}
+#endif
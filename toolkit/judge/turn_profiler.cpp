@@ -0,0 +1,193 @@
+#include "turn_profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <ostream>
+#include "error_check.hpp"
+#include "json_log.hpp"
+const char* turn_phase_name(TurnPhase p) {
+    switch (p) {
+        case TurnPhase::UPDATE_TURN:
+            return "update_turn";
+        case TurnPhase::OUTPUT_TURN_DATA:
+            return "output_turn_data";
+        case TurnPhase::INPUT_READ:
+            return "input_read";
+        case TurnPhase::INPUT_PARSE:
+            return "input_parse";
+        case TurnPhase::INPUT_VALIDATE:
+            return "input_validate";
+        case TurnPhase::INPUT_APPLY:
+            return "input_apply";
+        case TurnPhase::SOLVER_DECIDE:
+            return "solver_decide";
+        case TurnPhase::FINALIZE_TASKS:
+            return "finalize_tasks";
+        case TurnPhase::JSON_LOG:
+            return "json_log";
+        case TurnPhase::BINARY_LOG:
+            return "binary_log";
+        case TurnPhase::SEEKABLE_LOG:
+            return "seekable_log";
+        default:
+            return "invalid";
+    }
+}
+namespace {
+template <class... Args>
+void print_(std::ostream& os, const char* fmt, Args... args) {
+    char buf[256];
+    std::snprintf(buf, sizeof(buf), fmt, args...);
+    os << buf;
+}
+void print_bucket_(std::ostream& os, int b, int count) {
+    if (b == 0) {
+        print_(os, " <1us:%d", count);
+    } else if (b == TurnProfiler::HISTOGRAM_BUCKET_NUM - 1) {
+        print_(os, " >=%lldus:%d", 1LL << (b - 1), count);
+    } else {
+        print_(os, " %lld-%lldus:%d", 1LL << (b - 1), 1LL << b, count);
+    }
+}
+}
+int64_t nearest_rank(const std::vector<int64_t>& sorted, int percent) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    size_t rank = (sorted.size() * percent + 99) / 100;
+    return sorted[std::max<size_t>(rank, 1) - 1];
+}
+void TurnProfiler::begin_turn(discrete_time_t t_0b) {
+    THROW_LOGIC_ERROR_IF(t_0b < 0, "turn is out of range");
+    if (turns_.size() <= static_cast<size_t>(t_0b)) {
+        turns_.resize(t_0b + 1);
+    }
+    turns_[t_0b].fill(0);
+    current_ = t_0b;
+}
+int TurnProfiler::turn_num() const {
+    return turns_.size();
+}
+bool TurnProfiler::used(TurnPhase p) const {
+    return used_[static_cast<int>(p)];
+}
+int64_t TurnProfiler::elapsed_ns(discrete_time_t t_0b, TurnPhase p) const {
+    THROW_LOGIC_ERROR_IF(t_0b < 0 || t_0b >= turn_num(),
+                         "turn is out of range");
+    return turns_[t_0b][static_cast<int>(p)];
+}
+std::vector<int64_t> TurnProfiler::sorted_samples(TurnPhase p) const {
+    std::vector<int64_t> ret;
+    ret.reserve(turns_.size());
+    for (const auto& turn : turns_) {
+        ret.push_back(turn[static_cast<int>(p)]);
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+std::array<int, TurnProfiler::HISTOGRAM_BUCKET_NUM> TurnProfiler::histogram(
+    TurnPhase p) const {
+    std::array<int, HISTOGRAM_BUCKET_NUM> ret = {};
+    for (const auto& turn : turns_) {
+        int64_t us = turn[static_cast<int>(p)] / 1000;
+        int b = 0;
+        while (us > 0 && b < HISTOGRAM_BUCKET_NUM - 1) {
+            us >>= 1;
+            b++;
+        }
+        ret[b]++;
+    }
+    return ret;
+}
+void TurnProfiler::write_report(std::ostream& os) const {
+    int64_t all_total = 0;
+    for (const auto& turn : turns_) {
+        for (int64_t ns : turn) {
+            all_total += ns;
+        }
+    }
+    print_(os, "Turn profile: %d turns, %.3f ms in total\n", turn_num(),
+           all_total * 1e-6);
+    print_(os, "%-18s %12s %7s %10s %10s %10s %10s\n", "phase", "total[ms]",
+           "share", "mean[us]", "p50[us]", "p99[us]", "max[us]");
+    for (int i = 0; i < TURN_PHASE_NUM; i++) {
+        auto p = static_cast<TurnPhase>(i);
+        if (!used(p)) {
+            continue;
+        }
+        auto samples = sorted_samples(p);
+        int64_t total = 0;
+        for (int64_t ns : samples) {
+            total += ns;
+        }
+        print_(os, "%-18s %12.3f %6.1f%% %10.2f %10.2f %10.2f %10.2f\n",
+               turn_phase_name(p), total * 1e-6,
+               all_total > 0 ? 100.0 * total / all_total : 0.0,
+               samples.empty() ? 0.0 : total * 1e-3 / samples.size(),
+               nearest_rank(samples, 50) * 1e-3,
+               nearest_rank(samples, 99) * 1e-3,
+               samples.empty() ? 0.0 : samples.back() * 1e-3);
+    }
+    os << "Histogram (turns per bucket):\n";
+    for (int i = 0; i < TURN_PHASE_NUM; i++) {
+        auto p = static_cast<TurnPhase>(i);
+        if (!used(p)) {
+            continue;
+        }
+        print_(os, "%-18s", turn_phase_name(p));
+        auto h = histogram(p);
+        for (int b = 0; b < HISTOGRAM_BUCKET_NUM; b++) {
+            if (h[b] > 0) {
+                print_bucket_(os, b, h[b]);
+            }
+        }
+        os << "\n";
+    }
+    os.flush();
+}
+void TurnProfiler::write_json(JsonLogWriter& w) const {
+    std::vector<TurnPhase> phases;
+    for (int i = 0; i < TURN_PHASE_NUM; i++) {
+        if (used(static_cast<TurnPhase>(i))) {
+            phases.push_back(static_cast<TurnPhase>(i));
+        }
+    }
+    w.begin_object();
+    w.key("phases");
+    w.begin_array();
+    for (auto p : phases) {
+        w.value(turn_phase_name(p));
+    }
+    w.end_array();
+    w.key("summary");
+    w.begin_object();
+    for (auto p : phases) {
+        auto samples = sorted_samples(p);
+        int64_t total = 0;
+        for (int64_t ns : samples) {
+            total += ns;
+        }
+        w.key(turn_phase_name(p));
+        w.begin_object();
+        w.key("max_ns");
+        w.value(samples.empty() ? int64_t(0) : samples.back());
+        w.key("p50_ns");
+        w.value(nearest_rank(samples, 50));
+        w.key("p99_ns");
+        w.value(nearest_rank(samples, 99));
+        w.key("total_ns");
+        w.value(total);
+        w.end_object();
+    }
+    w.end_object();
+    w.key("turns_ns");
+    w.begin_array();
+    for (const auto& turn : turns_) {
+        w.begin_array();
+        for (auto p : phases) {
+            w.value(turn[static_cast<int>(p)]);
+        }
+        w.end_array();
+    }
+    w.end_array();
+    w.end_object();
+}
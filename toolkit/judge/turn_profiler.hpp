@@ -0,0 +1,72 @@
+#ifndef HEADER_2HC2022_TURN_PROFILER
+#define HEADER_2HC2022_TURN_PROFILER 
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+#include "defines.hpp"
+class JsonLogWriter;
+enum class TurnPhase : int {
+    UPDATE_TURN,
+    OUTPUT_TURN_DATA,
+    INPUT_READ,
+    INPUT_PARSE,
+    INPUT_VALIDATE,
+    INPUT_APPLY,
+    SOLVER_DECIDE,
+    FINALIZE_TASKS,
+    JSON_LOG,
+    BINARY_LOG,
+    SEEKABLE_LOG,
+    NUM
+};
+constexpr int TURN_PHASE_NUM = static_cast<int>(TurnPhase::NUM);
+const char* turn_phase_name(TurnPhase p);
+int64_t nearest_rank(const std::vector<int64_t>& sorted, int percent);
+class TurnProfiler {
+ public:
+    using clock = std::chrono::steady_clock;
+    static constexpr int HISTOGRAM_BUCKET_NUM = 24;
+ private:
+    std::vector<std::array<int64_t, TURN_PHASE_NUM>> turns_;
+    std::array<bool, TURN_PHASE_NUM> used_ = {};
+    discrete_time_t current_ = INVALID_TIME;
+ public:
+    void begin_turn(discrete_time_t t_0b);
+    void add(TurnPhase p, clock::duration d) {
+        if (current_ == INVALID_TIME) {
+            return;
+        }
+        turns_[current_][static_cast<int>(p)] +=
+            std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        used_[static_cast<int>(p)] = true;
+    }
+    int turn_num() const;
+    bool used(TurnPhase p) const;
+    int64_t elapsed_ns(discrete_time_t t_0b, TurnPhase p) const;
+    std::vector<int64_t> sorted_samples(TurnPhase p) const;
+    std::array<int, HISTOGRAM_BUCKET_NUM> histogram(TurnPhase p) const;
+    void write_report(std::ostream& os) const;
+    void write_json(JsonLogWriter& w) const;
+};
+class TurnPhaseTimer {
+    TurnProfiler* profiler_;
+    TurnPhase phase_;
+    TurnProfiler::clock::time_point begin_;
+ public:
+    TurnPhaseTimer(TurnProfiler* profiler, TurnPhase phase)
+        : profiler_(profiler), phase_(phase) {
+        if (profiler_) {
+            begin_ = TurnProfiler::clock::now();
+        }
+    }
+    TurnPhaseTimer(const TurnPhaseTimer&) = delete;
+    TurnPhaseTimer& operator=(const TurnPhaseTimer&) = delete;
+    ~TurnPhaseTimer() {
+        if (profiler_) {
+            profiler_->add(phase_, TurnProfiler::clock::now() - begin_);
+        }
+    }
+};
+#endif
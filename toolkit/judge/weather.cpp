@@ -2,11 +2,15 @@
 #include <algorithm>
 #include <utility>
 #include <vector>
+#include "binary_log.hpp"
 #include "error_check.hpp"
 #include "io.hpp"
+#include "json_log.hpp"
 #include "lib/Eigen/Core"
-#include "lib/Eigen/Eigenvalues"
 #include "lib/json.hpp"
+#include "philox.hpp"
+#include "snapshot.hpp"
+#include "stationary_dist.hpp"
 void WeatherManager::RowMajorMatrix::throw_if_invalid() const {
     THROW_RUNTIME_ERROR_IF(n_row <= 0, "Invalid row size");
     THROW_RUNTIME_ERROR_IF(n_col <= 0, "Invalid col size");
@@ -88,8 +92,13 @@ void WeatherManager::set_time_local_value(weather_value_t val) {
     time_local_value = val;
 }
 int WeatherManager::weather_division_length() const {
-    return (weather_probability_.size() - 1) /
-           current_division_weathers_.size();
+    return division_length_;
+}
+int WeatherManager::weather_division_num() const {
+    return current_division_weathers_.size();
+}
+WeatherSampling WeatherManager::sampling() const {
+    return sampling_;
 }
 int WeatherManager::weather_value_num() const {
     weather_trans_.throw_if_invalid();
@@ -122,66 +131,18 @@ using RowMajorEigenMatrixXd =
     Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>;
 std::vector<double>
 WeatherManager::compute_stationary_dist_(const RowMajorMatrix& mat_) {
-    {
-        std::vector<bool> all_0(mat_.n_col), all_1(mat_.n_col);
-        for (int c = 0; c < mat_.n_col; c++) {
-            all_0[c] = true;
-            all_1[c] = true;
-            for (int r = 0; r < mat_.n_row; r++) {
-                if (mat_(r, c) != 0.0) {
-                    all_0[c] = false;
-                }
-                if (mat_(r, c) != 1.0) {
-                    all_1[c] = false;
-                }
-            }
-        }
-        int zero_count = std::count(all_0.begin(), all_0.end(), true);
-        int one_count = std::count(all_1.begin(), all_1.end(), true);
-        if (zero_count == mat_.n_col - 1 && one_count == 1) {
-            std::vector<double> ret;
-            std::transform(all_1.begin(), all_1.end(), std::back_inserter(ret),
-                           [](bool b) { return b ? 1.0 : 0.0; });
-            return ret;
-        }
-    }
-    Eigen::Map<const RowMajorEigenMatrixXd> mat_map(&mat_.data[0], mat_.n_row,
-                                                    mat_.n_col);
-    Eigen::EigenSolver<RowMajorEigenMatrixXd> es(mat_map.transpose(), true);
-    Eigen::VectorXcd eigvals = es.eigenvalues();
-    int max_i = -1;
-    double max_abs_eigval = -1.0;
-    for (int i = 0; i < eigvals.size(); i++) {
-        double abs_eigval = std::abs(eigvals[i]);
-        if (max_abs_eigval < abs_eigval) {
-            max_i = i;
-            max_abs_eigval = abs_eigval;
-        }
-    }
-    std::complex<double> result_eigval = eigvals[max_i];
-    THROW_LOGIC_ERROR_IF(result_eigval.real() < 0.99,
-                         "eigval real part is too small :%g",
-                         result_eigval.real());
-    THROW_LOGIC_ERROR_IF(std::abs(result_eigval.imag()) > 0.01,
-                         "eigval imag part is too large :%g",
-                         result_eigval.imag());
-    Eigen::VectorXcd sta = es.eigenvectors().col(max_i);
-    std::vector<double> ret;
-    double esum = 0.0;
-    for (auto v : sta) {
-        esum += v.real();
-    }
-    for (int i = 0; i < sta.size(); i++) {
-        ret.push_back(sta[i].real() / esum);
-    }
-    return ret;
+    mat_.throw_if_invalid();
+    THROW_LOGIC_ERROR_IF(mat_.n_row != mat_.n_col,
+                         "Transition matrix must be square");
+    return stationary_distribution(mat_.data, mat_.n_row);
 }
 void to_json(json_ref j, const WeatherManager::RowMajorMatrix& m) {
     j = json{{"rows", m.n_row}, {"cols", m.n_col}, {"data", m.data}};
 }
 void WeatherManager::initialize_(
     std::vector<std::vector<double>> weather_transition_prob_mat,
-    int division_size, discrete_time_t t_max, uint64_t seed) {
+    int division_size, discrete_time_t t_max, uint64_t seed,
+    WeatherSampling sampling) {
     THROW_RUNTIME_ERROR_IF(division_size <= 0,
                            "Weather division size must be positive");
     THROW_RUNTIME_ERROR_IF(t_max <= 0, "T_max must be positive");
@@ -189,6 +150,8 @@ void WeatherManager::initialize_(
                            "T_max must be divisible by division size");
     THROW_RUNTIME_ERROR_IF(weather_transition_prob_mat.size() == 0,
                            "Weather transition matrix cannot be empty");
+    THROW_RUNTIME_ERROR_IF(sampling == WeatherSampling::INVALID,
+                           "Invalid weather sampling mode");
     {
         for (const auto& v : weather_transition_prob_mat) {
             THROW_RUNTIME_ERROR_IF(v.size() !=
@@ -204,6 +167,7 @@ void WeatherManager::initialize_(
     }
     engine_.seed(seed);
     seed_ = seed;
+    counter_key_ = seed;
     for (auto& v : weather_transition_prob_mat) {
         double sum = std::accumulate(v.begin(), v.end(), 0.0);
         std::for_each(v.begin(), v.end(), [&](double& p) { p /= sum; });
@@ -216,25 +180,135 @@ void WeatherManager::initialize_(
             weather_trans_(r, c) = weather_transition_prob_mat[r][c];
         }
     }
+    sampling_ = sampling;
+    transition_dists_.clear();
+    alias_prob_.clear();
+    alias_index_.clear();
+    if (sampling_ != WeatherSampling::DISCRETE_DISTRIBUTION) {
+        build_alias_tables_();
+    } else {
+        for (int r = 0; r < weather_trans_.n_row; r++) {
+            transition_dists_.emplace_back(weather_trans_.row_begin(r),
+                                           weather_trans_.row_end(r));
+        }
+    }
     {
         current_division_weathers_.resize(t_max / division_size);
         std::vector<double> sta = compute_stationary_dist_(weather_trans_);
-        std::discrete_distribution<int> dist(sta.begin(), sta.end());
-        for (auto& v : current_division_weathers_) {
-            v = dist(engine_);
+        if (sampling_ == WeatherSampling::PHILOX) {
+            const double sum = std::accumulate(sta.begin(), sta.end(), 0.0);
+            stationary_cumul_.clear();
+            double cumul = 0.0;
+            for (double p : sta) {
+                cumul += p / sum;
+                stationary_cumul_.push_back(cumul);
+            }
+            stationary_cumul_.back() = 1.0;
+            for (int c = 0; c < current_division_weathers_.size(); c++) {
+                current_division_weathers_[c] = counter_initial_(c);
+            }
+        } else {
+            std::discrete_distribution<int> dist(sta.begin(), sta.end());
+            for (auto& v : current_division_weathers_) {
+                v = dist(engine_);
+            }
         }
         time_local_value = current_division_weathers_[0];
     }
-    {
-        int nr = weather_trans_.n_row;
-        int nc = weather_trans_.n_col;
-        RowMajorEigenMatrixXd forecast =
+    division_length_ = division_size;
+    forecast_table_ = std::make_shared<ForecastTable>();
+}
+void WeatherManager::build_alias_tables_() {
+    const int n = weather_trans_.n_col;
+    alias_prob_.assign(n * n, 1.0);
+    alias_index_.resize(n * n);
+    std::vector<double> scaled(n);
+    std::vector<int> small, large;
+    for (int r = 0; r < n; r++) {
+        double* prob = &alias_prob_[r * n];
+        weather_value_t* alias = &alias_index_[r * n];
+        small.clear();
+        large.clear();
+        for (int c = 0; c < n; c++) {
+            scaled[c] = weather_trans_(r, c) * n;
+            alias[c] = c;
+            (scaled[c] < 1.0 ? small : large).push_back(c);
+        }
+        while (!small.empty() && !large.empty()) {
+            const int s = small.back();
+            const int l = large.back();
+            small.pop_back();
+            prob[s] = scaled[s];
+            alias[s] = l;
+            scaled[l] -= 1.0 - scaled[s];
+            if (scaled[l] < 1.0) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+    }
+}
+weather_value_t WeatherManager::alias_sample_(weather_value_t from,
+                                              uint64_t r) const {
+    const int n = weather_trans_.n_col;
+    const double x = static_cast<double>(r >> 11) * 0x1.0p-53 * n;
+    const int c = std::min(static_cast<int>(x), n - 1);
+    const size_t k = static_cast<size_t>(from) * n + c;
+    return x - c < alias_prob_[k] ? c : alias_index_[k];
+}
+uint64_t WeatherManager::counter_random_(discrete_time_t t, int stream,
+                                         int purpose) const {
+    return Philox4x32::generate64(
+        {static_cast<uint32_t>(t), static_cast<uint32_t>(stream),
+         static_cast<uint32_t>(purpose), 0},
+        counter_key_);
+}
+weather_value_t WeatherManager::counter_initial_(int division) const {
+    const double u =
+        static_cast<double>(counter_random_(0, division, 0) >> 11) * 0x1.0p-53;
+    return std::lower_bound(stationary_cumul_.begin(), stationary_cumul_.end(),
+                            u) -
+           stationary_cumul_.begin();
+}
+weather_value_t WeatherManager::counter_transition_(weather_value_t from,
+                                                    discrete_time_t t,
+                                                    int stream) const {
+    return alias_sample_(from, counter_random_(t, stream, 1));
+}
+weather_value_t WeatherManager::transition_(weather_value_t from,
+                                            discrete_time_t t, int stream) {
+    switch (sampling_) {
+    case WeatherSampling::PHILOX:
+        return counter_transition_(from, t, stream);
+    case WeatherSampling::ALIAS:
+        return alias_sample_(from, engine_());
+    default:
+        return transition_dists_[from](engine_);
+    }
+}
+const WeatherManager::RowMajorMatrix&
+WeatherManager::forecast_matrix_(int division_offset) const {
+    THROW_LOGIC_ERROR_IF(division_offset < 0 ||
+                             division_offset >= weather_division_num(),
+                         "Forecast offset is out of range: %d",
+                         division_offset);
+    ForecastTable& table = *forecast_table_;
+    std::lock_guard<std::mutex> lock(table.mutex);
+    int nr = weather_trans_.n_row;
+    int nc = weather_trans_.n_col;
+    if (table.powers.empty()) {
+        RowMajorEigenMatrixXd identity =
             RowMajorEigenMatrixXd::Identity(nr, nc);
-        Eigen::Map<const RowMajorEigenMatrixXd> wp(&weather_trans_.data[0], nr,
-                                                   nc);
-        weather_probability_.emplace_back(forecast.data(), nr, nc);
-        weather_probability_.back().generate_row_strings();
-        for (int i = 0; i < t_max; i++) {
+        table.powers.emplace_back(identity.data(), nr, nc);
+        table.powers.back().generate_row_strings();
+    }
+    Eigen::Map<const RowMajorEigenMatrixXd> wp(&weather_trans_.data[0], nr,
+                                               nc);
+    while (static_cast<int>(table.powers.size()) <= division_offset) {
+        RowMajorEigenMatrixXd forecast =
+            Eigen::Map<const RowMajorEigenMatrixXd>(
+                &table.powers.back().data[0], nr, nc);
+        for (int i = 0; i < division_length_; i++) {
             forecast = wp * forecast;
             for (int j = 0; j < forecast.rows(); j++) {
                 double sum = 0.0;
@@ -245,61 +319,96 @@ void WeatherManager::initialize_(
                     forecast(j, k) /= sum;
                 }
             }
-            weather_probability_.emplace_back(forecast.data(), nr, nc);
-            weather_probability_.back().generate_row_strings();
         }
+        table.powers.emplace_back(forecast.data(), nr, nc);
+        table.powers.back().generate_row_strings();
     }
+    return table.powers[division_offset];
 }
 std::vector<std::vector<double>>
 WeatherManager::probability_forecast(discrete_time_t t) const {
-    size_t division_count = current_division_weathers_.size();
-    size_t total_time = weather_probability_.size() - 1;
-    size_t value_num = weather_trans_.n_row;
-    int division_size = total_time / division_count;
-    std::vector<std::vector<double>> ret(total_time - t + 1,
-                                         std::vector<double>(value_num));
-    for (int i = t; i < total_time; i++) {
-        int c = i / division_size;
-        ret[i - t] =
-            weather_probability_[i - t].get_row(current_division_weathers_[c]);
+    THROW_LOGIC_ERROR_IF(t % division_length_ != 0,
+                         "Forecast is only available at division boundaries");
+    const int first = t / division_length_;
+    std::vector<std::vector<double>> ret;
+    for (int c = first; c < weather_division_num(); c++) {
+        ret.push_back(forecast_matrix_(c - first).get_row(
+            current_division_weathers_[c]));
     }
     return ret;
 }
 std::vector<const std::string*>
 WeatherManager::probability_forecast_string(discrete_time_t t) const {
-    size_t division_count = current_division_weathers_.size();
-    size_t total_time = weather_probability_.size() - 1;
-    size_t value_num = weather_trans_.n_row;
-    int division_size = total_time / division_count;
-    std::vector<const std::string*> ret(total_time - t + 1);
-    for (int i = t; i < total_time; i++) {
-        int c = i / division_size;
-        ret[i - t] = &(weather_probability_[i - t].get_row_string(
+    THROW_LOGIC_ERROR_IF(t % division_length_ != 0,
+                         "Forecast is only available at division boundaries");
+    const int first = t / division_length_;
+    std::vector<const std::string*> ret;
+    for (int c = first; c < weather_division_num(); c++) {
+        ret.push_back(&forecast_matrix_(c - first).get_row_string(
             current_division_weathers_[c]));
     }
     return ret;
 }
 void WeatherManager::update(discrete_time_t current_time) {
-    int div_size =
-        (weather_probability_.size() - 1) / current_division_weathers_.size();
+    int div_size = division_length_;
     if (current_time % div_size == 0) {
-        for (auto& w : current_division_weathers_) {
-            std::discrete_distribution<int> dist(weather_trans_.row_begin(w),
-                                                 weather_trans_.row_end(w));
-            w = dist(engine_);
+        for (int c = 0; c < current_division_weathers_.size(); c++) {
+            current_division_weathers_[c] =
+                transition_(current_division_weathers_[c], current_time, c);
         }
         int division_value =
-            current_division_weathers_[current_time /
-                                       ((weather_probability_.size() - 1) /
-                                        current_division_weathers_.size())];
+            current_division_weathers_[current_time / div_size];
         set_time_local_value(division_value);
     } else {
-        std::discrete_distribution<int> dist(
-            weather_trans_.row_begin(time_local_value),
-            weather_trans_.row_end(time_local_value));
-        time_local_value = dist(engine_);
+        time_local_value = transition_(time_local_value, current_time,
+                                       weather_division_num());
     }
 }
+weather_value_t WeatherManager::weather_at(discrete_time_t t) const {
+    THROW_LOGIC_ERROR_IF(sampling_ != WeatherSampling::PHILOX,
+                         "Random access to the weather needs PHILOX mode");
+    const int division = t / division_length_;
+    const discrete_time_t begin = division * division_length_;
+    weather_value_t w = counter_initial_(division);
+    for (discrete_time_t s = division_length_; s <= begin;
+         s += division_length_) {
+        w = counter_transition_(w, s, division);
+    }
+    for (discrete_time_t s = begin + 1; s <= t; s++) {
+        w = counter_transition_(w, s, weather_division_num());
+    }
+    return w;
+}
+std::vector<weather_value_t>
+WeatherManager::division_weathers_at(discrete_time_t t) const {
+    THROW_LOGIC_ERROR_IF(sampling_ != WeatherSampling::PHILOX,
+                         "Random access to the weather needs PHILOX mode");
+    std::vector<weather_value_t> ret(weather_division_num());
+    for (int c = 0; c < ret.size(); c++) {
+        ret[c] = counter_initial_(c);
+        for (discrete_time_t s = division_length_; s <= t;
+             s += division_length_) {
+            ret[c] = counter_transition_(ret[c], s, c);
+        }
+    }
+    return ret;
+}
+void WeatherManager::snapshot(SnapshotWriter& w) const {
+    w.write(engine_);
+    w.write(counter_key_);
+    w.write_sequence(current_division_weathers_);
+    w.write(time_local_value);
+}
+void WeatherManager::restore(SnapshotReader& r) {
+    r.read(engine_);
+    r.read(counter_key_);
+    r.read_sequence(current_division_weathers_);
+    r.read(time_local_value);
+}
+void WeatherManager::reseed(uint64_t seed) {
+    engine_.seed(seed);
+    counter_key_ = seed;
+}
 weather_value_t WeatherManager::get_weather_value(discrete_time_t t) const {
     return time_local_value;
 }
@@ -307,11 +416,21 @@ void WeatherManager::read_from_stream(std::istream& is, discrete_time_t t_max) {
     ValueReader r(is);
     int value_num, division_size;
     uint64_t seed;
-    readline_exact(
-        r,
-        TAG(ValueGroup::POSITIVE_COUNT, value_num),
-        TAG(ValueGroup::POSITIVE_DURATION, division_size),
-        TAG(ValueGroup::SEED, seed));
+    WeatherSampling sampling = WeatherSampling::DISCRETE_DISTRIBUTION;
+    {
+        auto ssr = get_single_line_stream(r);
+        read_vars(ssr, TAG(ValueGroup::POSITIVE_COUNT, value_num),
+                  TAG(ValueGroup::POSITIVE_DURATION, division_size),
+                  TAG(ValueGroup::SEED, seed));
+        std::string sampling_str;
+        if (ssr.is >> sampling_str) {
+            sampling = to_weather_sampling(sampling_str);
+            THROW_RUNTIME_ERROR_IF(sampling == WeatherSampling::INVALID,
+                                   "Unknown weather sampling mode: %s",
+                                   sampling_str.c_str());
+        }
+        throw_if_nontrivial_chars_left(ssr);
+    }
     THROW_RUNTIME_ERROR_IF(value_num <= 0, "Invalid weather value num");
     std::vector<std::vector<double>> wp(value_num,
                                         std::vector<double>(value_num));
@@ -323,20 +442,31 @@ void WeatherManager::read_from_stream(std::istream& is, discrete_time_t t_max) {
                                       wp[i][j++] = p;
                                   });
     }
-    initialize_(std::move(wp), division_size, t_max, seed);
+    initialize_(std::move(wp), division_size, t_max, seed, sampling);
 }
-void to_json(json_ref j, const WeatherManager& wm) {
-    if (wm.log_mutable_only_) {
-        j = json{
-            {"division_weathers", wm.current_division_weathers_},
-            {"time_local_weather", wm.time_local_value},
-        };
-    } else {
-        j = json{
-            {"trans_mat", wm.weather_trans_},
-            {"division_weathers", wm.current_division_weathers_},
-            {"time_local_weather", wm.time_local_value},
-            {"seed", wm.seed_},
-        };
+void WeatherManager::write_turn_log(BinaryLogWriter& w) const {
+    for (weather_value_t v : current_division_weathers_) {
+        w.add_weather(v);
     }
+    w.add_weather(time_local_value);
+}
+void WeatherManager::write_turn_log(JsonLogWriter& w) const {
+    w.begin_object();
+    w.key("division_weathers");
+    w.begin_array();
+    for (weather_value_t v : current_division_weathers_) {
+        w.value(v);
+    }
+    w.end_array();
+    w.key("time_local_weather");
+    w.value(time_local_value);
+    w.end_object();
+}
+void to_json(json_ref j, const WeatherManager& wm) {
+    j = json{
+        {"trans_mat", wm.weather_trans_},
+        {"division_weathers", wm.current_division_weathers_},
+        {"time_local_weather", wm.time_local_value},
+        {"seed", wm.seed_},
+    };
 }
@@ -1,12 +1,40 @@
 #ifndef HEADER_2HC2022_WEATHER
 #define HEADER_2HC2022_WEATHER 
+#include <deque>
+#include <memory>
+#include <mutex>
 #include <random>
+#include <string>
 #include <vector>
 #include "defines.hpp"
 #include "io.hpp"
 #include "json_fwd.hpp"
 using weather_value_t = int;
-class WeatherManager : public LogInfoSwitcher {
+// How weather transitions are drawn. DISCRETE_DISTRIBUTION reproduces the
+// std::discrete_distribution draw sequence of existing testcases. PHILOX
+// keys every draw by (seed, turn, division) instead of a sequential engine,
+// so the weather at any turn can be computed on its own.
+enum class WeatherSampling : int {
+    INVALID,
+    DISCRETE_DISTRIBUTION,
+    ALIAS,
+    PHILOX
+};
+inline WeatherSampling to_weather_sampling(const std::string& str) {
+    if (str == "discrete_distribution") {
+        return WeatherSampling::DISCRETE_DISTRIBUTION;
+    } else if (str == "alias") {
+        return WeatherSampling::ALIAS;
+    } else if (str == "philox") {
+        return WeatherSampling::PHILOX;
+    }
+    return WeatherSampling::INVALID;
+}
+class SnapshotReader;
+class BinaryLogWriter;
+class JsonLogWriter;
+class SnapshotWriter;
+class WeatherManager {
  public:
     struct RowMajorMatrix {
         using row_major_matrix_raw_t = std::vector<double>;
@@ -32,17 +60,40 @@ class WeatherManager : public LogInfoSwitcher {
         friend void to_json(json_ref j, const RowMajorMatrix& rmm);
     };
  private:
-    std::vector<RowMajorMatrix> weather_probability_;
+    // powers[k]: transition probabilities k divisions ahead, extended on
+    // demand (only division boundaries are forecast).
+    struct ForecastTable {
+        std::mutex mutex;
+        std::deque<RowMajorMatrix> powers;
+    };
+    std::shared_ptr<ForecastTable> forecast_table_;
     std::vector<weather_value_t> current_division_weathers_;
     RowMajorMatrix weather_trans_;
+    WeatherSampling sampling_ = WeatherSampling::DISCRETE_DISTRIBUTION;
+    std::vector<std::discrete_distribution<int>> transition_dists_;
+    std::vector<double> alias_prob_;
+    std::vector<weather_value_t> alias_index_;
+    std::vector<double> stationary_cumul_;
     std::mt19937_64 engine_;
+    uint64_t counter_key_ = 0;
     weather_value_t time_local_value = -1;
     uint64_t seed_ = 0;
+    int division_length_ = -1;
     void
     initialize_(std::vector<std::vector<double>> weather_transition_prob_mat,
-                int division_size, discrete_time_t t_max, uint64_t seed);
+                int division_size, discrete_time_t t_max, uint64_t seed,
+                WeatherSampling sampling);
+    void build_alias_tables_();
+    weather_value_t alias_sample_(weather_value_t from, uint64_t r) const;
+    uint64_t counter_random_(discrete_time_t t, int stream, int purpose) const;
+    weather_value_t counter_initial_(int division) const;
+    weather_value_t counter_transition_(weather_value_t from, discrete_time_t t,
+                                        int stream) const;
+    weather_value_t transition_(weather_value_t from, discrete_time_t t,
+                                int stream);
     static std::vector<double>
     compute_stationary_dist_(const RowMajorMatrix& mat_);
+    const RowMajorMatrix& forecast_matrix_(int division_offset) const;
  public:
     void set_time_local_value(weather_value_t val);
     void read_from_stream(std::istream& is, discrete_time_t t_max);
@@ -51,9 +102,19 @@ class WeatherManager : public LogInfoSwitcher {
     std::vector<const std::string*>
     probability_forecast_string(discrete_time_t t) const;
     void update(discrete_time_t current_time);
+    void reseed(uint64_t seed);
+    void snapshot(SnapshotWriter& w) const;
+    void write_turn_log(JsonLogWriter& w) const;
+    void write_turn_log(BinaryLogWriter& w) const;
+    void restore(SnapshotReader& r);
     weather_value_t get_weather_value(discrete_time_t current_time) const;
+    // PHILOX only: the state at the end of turn t without replaying.
+    weather_value_t weather_at(discrete_time_t t) const;
+    std::vector<weather_value_t> division_weathers_at(discrete_time_t t) const;
     int weather_division_length() const;
+    int weather_division_num() const;
     int weather_value_num() const;
+    WeatherSampling sampling() const;
     void output_transition_matrix_to_contestant_WITH_TRAILING_NEWLINE(
         std::ostream& os) const;
     friend void to_json(json_ref j, const WeatherManager& wm);
@@ -3,33 +3,29 @@
 #include <sstream>
 #include <string>
 #include <utility>
+#include "binary_log.hpp"
 #include "io.hpp"
 #include "job.hpp"
 #include "job_manager.hpp"
+#include "json_log.hpp"
 #include "lib/json.hpp"
 #include "logger.hpp"
+#include "snapshot.hpp"
 #include "worker_manager.hpp"
-bool WorkerInfo::is_valid(std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    VALIDITY_CHECK_WITH_MSG(processable_types.empty(), valid, msg,
-                            "This worker has no processable types.");
+CheckCode WorkerInfo::check() const {
+    RETURN_CHECK_CODE_IF(processable_types.empty(),
+                         WORKER_HAS_NO_PROCESSABLE_TYPE);
     for (auto t : processable_types) {
-        VALIDITY_CHECK_WITH_MSG(
-            t < 0 || t == INVALID_JOB_TYPE, valid, msg,
-            "Processable type(internal:%d) is invalid or out of range.", t);
+        RETURN_CHECK_CODE_IF(t < 0 || t == INVALID_JOB_TYPE,
+                             WORKER_PROCESSABLE_TYPE_IS_INVALID);
     }
-    VALIDITY_CHECK_WITH_MSG(initial_position == INVALID_VERTEX_ID, valid, msg,
-                            "This worker's initial position is invalid.");
-    VALIDITY_CHECK_WITH_MSG(initial_position == INVALID_VERTEX_ID, valid, msg,
-                            "This worker's initial position(internal vertex "
-                            "index:%d) is out of range.",
-                            initial_position);
-    VALIDITY_CHECK_WITH_MSG(
-        max_task <= 0, valid, msg,
-        "This worker has 0 or negative max task process amount(%d)", max_task);
-    return valid;
+    RETURN_CHECK_CODE_IF(initial_position == INVALID_VERTEX_ID,
+                         WORKER_INITIAL_POSITION_IS_INVALID);
+    RETURN_CHECK_CODE_IF(max_task <= 0, WORKER_MAX_TASK_IS_NOT_POSITIVE);
+    return CheckCode::OK;
+}
+bool WorkerInfo::is_valid(std::string* msg) const {
+    return report_check(check(), msg);
 }
 void WorkerInfo::read_from_stream(std::istream& is_) {
     ValueReader r(is_);
@@ -51,19 +47,19 @@ void WorkerInfo::read_from_stream(std::istream& is_) {
         ssr, n_job_type, ValueGroup::TYPEID, [&](job_type_t jt) {
             processable_types.emplace(jt);
         });
-    std::string msg;
+    const CheckCode code = check();
     THROW_RUNTIME_ERROR_IF(
-        !is_valid(&msg),
+        code != CheckCode::OK,
         "This worker info is still invalid after successfully read data from "
         "stream for the following reason(s):%s",
-        msg.c_str());
+        check_code_to_str(code));
 }
 bool WorkerInfo::can_process(job_type_t jt) const {
-    std::string msg;
+    const CheckCode code = check();
     THROW_RUNTIME_ERROR_IF(
-        !is_valid(&msg),
+        code != CheckCode::OK,
         "This worker info is invalid for the following reason(s):%s",
-        msg.c_str());
+        check_code_to_str(code));
     return processable_types.find(jt) != processable_types.end();
 }
 void to_json(json_ref j, const WorkerInfo& wi) {
@@ -80,19 +76,18 @@ Position WorkerState::current_position() const {
 void WorkerState::initialize(const Position& p) {
     current_pos_ = p;
 }
+CheckCode WorkerState::check(const UndirectedGraph& graph) const {
+    return graph.check_position(current_pos_);
+}
 bool WorkerState::is_valid(const UndirectedGraph& graph,
                            std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    {
-        std::string pmsg;
-        VALIDITY_CHECK_WITH_MSG(
-            !graph.is_position_valid(current_pos_, &pmsg), valid, msg,
-            "Current position is invalid for the following reason(s):%s",
-            pmsg.c_str());
-    }
-    return valid;
+    return graph.is_position_valid(current_pos_, msg);
+}
+void WorkerState::snapshot(SnapshotWriter& w) const {
+    w.write(current_pos_);
+}
+void WorkerState::restore(SnapshotReader& r) {
+    r.read(current_pos_);
 }
 void to_json(json_ref j, const WorkerState& ws) {
     j = json{{"current_position", ws.current_position()}};
@@ -107,43 +102,35 @@ void to_json(json_ref j, const TaskExecutionRecord& ter) {
         {"amount", ter.amount},
     };
 }
-bool Worker::is_valid(std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
+CheckCode Worker::check() const {
     if (always_valid_) {
-        *msg = "Validity check is skipped due to 'always_valid_' flag\n";
-        return true;
+        return CheckCode::OK;
     }
-    VALIDITY_CHECK_WITH_MSG(graph == nullptr, valid, msg, "Graph is not set.");
-    VALIDITY_CHECK_WITH_MSG(man_ == nullptr, valid, msg,
-                            "WorkerManager is not set.");
-    VALIDITY_CHECK_WITH_MSG(id() == INVALID_WORKER_ID, valid, msg,
-                            "Worker id is invalid.");
-    {
-        std::string info_msg;
-        VALIDITY_CHECK_WITH_MSG(
-            !info.is_valid(&info_msg), valid, msg,
-            "Worker info is invalid for the following reason(s):%s",
-            info_msg.c_str());
-    }
-    {
-        std::string state_msg;
-        VALIDITY_CHECK_WITH_MSG(
-            !state.is_valid(*graph, &state_msg), valid, msg,
-            "Worker state is invalid for the following reason(s):%s",
-            state_msg.c_str());
+    RETURN_CHECK_CODE_IF(graph == nullptr, WORKER_GRAPH_IS_NOT_SET);
+    RETURN_CHECK_CODE_IF(man_ == nullptr, WORKER_MANAGER_IS_NOT_SET);
+    RETURN_CHECK_CODE_IF(id() == INVALID_WORKER_ID, WORKER_ID_IS_INVALID);
+    RETURN_IF_CHECK_FAILED(info.check());
+    RETURN_IF_CHECK_FAILED(state.check(*graph));
+    return CheckCode::OK;
+}
+bool Worker::is_valid(std::string* msg) const {
+    if (always_valid_ && msg) {
+        *msg = "Validity check is skipped due to 'always_valid_' flag\n";
     }
-    return valid;
+    return report_check(check(), always_valid_ ? nullptr : msg);
+}
+void Worker::check_state_(const char* when) const {
+    THROW_INVARIANT_ERROR_IF(check() != CheckCode::OK,
+                             "(%s) This worker is invalid for the following "
+                             "reason(s):%s",
+                             when, check_code_to_str(check()));
 }
 void Worker::initialize() {
-    {
-        std::string msg;
-        THROW_RUNTIME_ERROR_IF(
-            !info.is_valid(&msg),
-            "The worker info is invalid for the following reason(s):%s",
-            msg.c_str());
-    }
+    const CheckCode code = info.check();
+    THROW_RUNTIME_ERROR_IF(
+        code != CheckCode::OK,
+        "The worker info is invalid for the following reason(s):%s",
+        check_code_to_str(code));
     state.initialize(Position{info.initial_position});
 }
 void Worker::read_worker_info(std::istream& is) {
@@ -166,13 +153,14 @@ void WorkerState::move_towards(vertex_index_t to,
     THROW_WA_IF(WrongAnswerType::MOVE_VERTEX_DOES_NOT_EXIST,
                 !graph.vertex_exists(to), "move dest does not exist");
     THROW_WA_IF(WrongAnswerType::DO_NOT_SPECIFY_NONSENSE_MOVE_ACTION,
-                graph.distance(current_pos_, to) == 0, "nonsense move action");
+                current_pos_.is_exact_vertex() && current_pos_.u == to,
+                "nonsense move action");
     auto next_v =
         graph.next_vertex(current_pos_, to);
     THROW_WA_IF(WrongAnswerType::INVALID_MOVE_DESTINATION,
                 next_v == INVALID_VERTEX_ID,
                 "Cannot move to vertex:%d from position:%s", to,
-                stream_to_string(current_pos_));
+                stream_to_string(current_pos_).c_str());
     if (current_pos_.is_exact_vertex()) {
         current_pos_.v = next_v;
         current_pos_.distance_from_u = 1;
@@ -191,28 +179,17 @@ void WorkerState::move_towards(vertex_index_t to,
     DEBUG("This MOVE operation has successfully finished.");
 }
 void Worker::do_action(discrete_time_t current_time, const action::Action& a) {
-    a.dispatch(current_time, this);
+    std::visit([&](const auto& x) { do_action(current_time, x); }, a);
 }
 void Worker::do_action(discrete_time_t current_time, const action::Stay& s) {
 }
 void Worker::do_action(discrete_time_t current_time, const action::Move& m) {
-    {
-        std::string wmsg;
-        THROW_RUNTIME_ERROR_IF(!is_valid(&wmsg),
-                               "(before moving) This worker is invalid for the "
-                               "following reason(s):%s",
-                               wmsg.c_str());
-    }
+    THROW_INVARIANT_ERROR_IF(graph == nullptr, "Graph is not set.");
     state.move_towards(m.to, *graph);
+    check_state_("after moving");
 }
 void Worker::do_action(discrete_time_t current_time, const action::Execute& e) {
-    {
-        std::string wmsg;
-        THROW_RUNTIME_ERROR_IF(!is_valid(&wmsg),
-                               "(before executing a job) This worker is "
-                               "invalid for the following reason(s):%s",
-                               wmsg.c_str());
-    }
+    THROW_INVARIANT_ERROR_IF(man_ == nullptr, "WorkerManager is not set.");
     man_->execute_job(current_time, *this, e.job_id, e.amount);
     TaskExecutionRecord r;
     r.time = current_time;
@@ -223,37 +200,107 @@ void Worker::do_action(discrete_time_t current_time, const action::Execute& e) {
 }
 void Worker::move_FORCE(const Position& p) {
     state.current_pos_ = p;
+    check_state_("after a forced move");
     DEBUG("Forced to move to position:%s", stream_to_string(p).c_str());
 }
 const std::set<TaskExecutionRecord>& Worker::task_history() const {
     return task_history_;
 }
+const action::ActionRecord& Worker::last_action() const {
+    THROW_LOGIC_ERROR_IF(action_history_.empty(),
+                         "Worker %d has not acted yet.", id());
+    return action_history_.back();
+}
+std::vector<std::string> Worker::raw_action_history() const {
+    std::vector<std::string> ret;
+    ret.reserve(action_history_.size());
+    for (const auto& r : action_history_) {
+        ret.push_back(r.to_raw_string());
+    }
+    return ret;
+}
 bool Worker::can_process(job_type_t jt) const {
     return info.can_process(jt);
 }
 void Worker::set_always_valid_DO_NOT_USE_(bool valid) {
     always_valid_ = valid;
 }
-void Worker::log_raw_action_string(std::string a) {
-    raw_action_history_.push_back(a);
+void Worker::log_action(const action::Action& a, int trailing_space_num) {
+    action_history_.push_back(action::ActionRecord{a, trailing_space_num});
 }
-void to_json(json_ref j, const Worker& w) {
-    if (w.log_mutable_only_) {
-        j = json{
-            {"id", w.id()},
-            {"state", w.state},
-            {"last_action", w.raw_action_history_.empty()
-                                ? ""
-                                : w.raw_action_history_.back()}
-        };
-    } else {
-        j = json{
-            {"id", w.id()},
-            {"info", w.info},
-            {"state", w.state},
-            {"task_history", w.task_history()},
-            {"is_valid", w.is_valid()},
-            {"raw_action_history", w.raw_action_history_}
-        };
+void Worker::replay_history(discrete_time_t current_time,
+                            const action::ActionRecord& r) {
+    THROW_LOGIC_ERROR_IF(
+        current_time != static_cast<discrete_time_t>(action_history_.size()),
+        "History of worker %d must be replayed turn by turn.", id());
+    if (const auto* e = std::get_if<action::Execute>(&r.action)) {
+        TaskExecutionRecord ter;
+        ter.time = current_time;
+        ter.id = e->job_id;
+        ter.amount = e->amount;
+        task_history_.emplace(std::move(ter));
+    }
+    action_history_.push_back(r);
+}
+discrete_time_t Worker::history_length() const {
+    return action_history_.size();
+}
+void Worker::snapshot(SnapshotWriter& w) const {
+    state.snapshot(w);
+    w.write<uint64_t>(action_history_.size());
+    if (!action_history_.empty()) {
+        w.write(action_history_.back());
     }
 }
+void Worker::restore(SnapshotReader& r) {
+    state.restore(r);
+    check_state_("after restoring");
+    const auto n = r.read<uint64_t>();
+    THROW_LOGIC_ERROR_IF(n > action_history_.size(),
+                         "History of worker %d is shorter than the snapshot.",
+                         id());
+    action_history_.resize(n);
+    if (n > 0) {
+        r.read(action_history_.back());
+    }
+    TaskExecutionRecord first_dropped;
+    first_dropped.time = n;
+    task_history_.erase(task_history_.lower_bound(first_dropped),
+                        task_history_.end());
+}
+void Worker::write_turn_log(BinaryLogWriter& w) const {
+    w.add_worker(current_position(),
+                 action_history_.empty() ? nullptr : &action_history_.back());
+}
+void Worker::write_turn_log(JsonLogWriter& w) const {
+    const Position p = current_position();
+    w.begin_object();
+    w.key("id");
+    w.value(id());
+    w.key("last_action");
+    w.value(action_history_.empty() ? std::string()
+                                    : action_history_.back().to_raw_string());
+    w.key("state");
+    w.begin_object();
+    w.key("current_position");
+    w.begin_object();
+    w.key("distance_from_u");
+    w.value(p.distance_from_u);
+    w.key("u");
+    w.value(p.u);
+    w.key("v");
+    w.value(p.v);
+    w.end_object();
+    w.end_object();
+    w.end_object();
+}
+void to_json(json_ref j, const Worker& w) {
+    j = json{
+        {"id", w.id()},
+        {"info", w.info},
+        {"state", w.state},
+        {"task_history", w.task_history()},
+        {"is_valid", w.is_valid()},
+        {"raw_action_history", w.raw_action_history()}
+    };
+}
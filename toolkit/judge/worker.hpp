@@ -10,11 +10,17 @@
 #include "job_manager.hpp"
 #include "json_fwd.hpp"
 #include "schedule.hpp"
+class SnapshotReader;
+class BinaryLogWriter;
+class JsonLogWriter;
+class SnapshotWriter;
+class Worker;
 class WorkerManager;
 struct WorkerInfo {
     vertex_index_t initial_position = INVALID_VERTEX_ID;
     std::set<job_type_t> processable_types;
     int max_task = -1;
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
     void read_from_stream(std::istream& is_);
     bool can_process(job_type_t jt) const;
@@ -26,6 +32,9 @@ class WorkerState {
     void move_towards(vertex_index_t target, const UndirectedGraph& graph);
     Position current_position() const;
     void initialize(const Position& p);
+    void snapshot(SnapshotWriter& w) const;
+    void restore(SnapshotReader& r);
+    CheckCode check(const UndirectedGraph& graph) const;
     bool is_valid(const UndirectedGraph& graph,
                   std::string* msg = nullptr) const;
     friend void to_json(json_ref j, const WorkerState& ws);
@@ -38,14 +47,15 @@ struct TaskExecutionRecord {
     bool operator<(const TaskExecutionRecord& e) const;
     friend void to_json(json_ref j, const TaskExecutionRecord& ter);
 };
-class Worker : public LogInfoSwitcher {
+class Worker {
     worker_id_t id_ = INVALID_WORKER_ID;
     WorkerManager* man_ = nullptr;
     std::set<TaskExecutionRecord> task_history_;
-    std::vector<std::string> raw_action_history_;
+    std::vector<action::ActionRecord> action_history_;
     bool always_valid_ = false;
+    void check_state_(const char* when) const;
  public:
-    void log_raw_action_string(std::string a);
+    void log_action(const action::Action& a, int trailing_space_num = 0);
     worker_id_t id() const;
     const UndirectedGraph* graph = nullptr;
     WorkerInfo info;
@@ -60,10 +70,24 @@ class Worker : public LogInfoSwitcher {
     Position current_position() const;
     void read_worker_info(std::istream& is);
     void initialize();
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
     bool can_process(job_type_t jt) const;
     const std::set<TaskExecutionRecord>& task_history() const;
+    std::vector<std::string> raw_action_history() const;
+    const action::ActionRecord& last_action() const;
     void set_always_valid_DO_NOT_USE_(bool valid);
+    // Appends the action of turn current_time without executing it.
+    void replay_history(discrete_time_t current_time,
+                        const action::ActionRecord& r);
+    discrete_time_t history_length() const;
+    // A snapshot holds the position and the last action only. restore()
+    // truncates the histories to the snapshot's turn, so they must already
+    // reach it (see replay_history).
+    void snapshot(SnapshotWriter& w) const;
+    void restore(SnapshotReader& r);
+    void write_turn_log(JsonLogWriter& w) const;
+    void write_turn_log(BinaryLogWriter& w) const;
     friend void to_json(json_ref j, const Worker& w);
     friend WorkerManager;
 };
@@ -1,7 +1,20 @@
 #include "worker_manager.hpp"
+#include <utility>
+#include "binary_log.hpp"
 #include "io.hpp"
+#include "json_log.hpp"
 #include "lib/json.hpp"
 #include "logger.hpp"
+#include "snapshot.hpp"
+WorkerManager::WorkerManager(const WorkerManager& wm)
+    : workers_(wm.workers_),
+      job_man_(wm.job_man_),
+      sch_man_(wm.sch_man_),
+      graph_(wm.graph_) {
+    for (auto& w : workers_) {
+        w.set_worker_manager(this);
+    }
+}
 void WorkerManager::set_schedule_manager(ScheduleManager* sm) {
     sch_man_ = sm;
 }
@@ -18,51 +31,77 @@ const Worker& WorkerManager::workers(int id) const {
     THROW_RUNTIME_ERROR_IF(!exists(id), "worker id is out of range");
     return workers_.at(id);
 }
-bool WorkerManager::is_valid(std::string* msg) const {
-    bool valid = true;
-    if (msg)
-        msg->clear();
-    VALIDITY_CHECK_WITH_MSG(job_man_ == nullptr, valid, msg,
-                            "JobManager is not set.");
-    VALIDITY_CHECK_WITH_MSG(graph_ == nullptr, valid, msg, "Graph is not set.");
-    VALIDITY_CHECK_WITH_MSG(workers_.empty(), valid, msg, "No worker exists.");
+CheckCode WorkerManager::check() const {
+    RETURN_CHECK_CODE_IF(job_man_ == nullptr,
+                         WORKER_MANAGER_JOB_MANAGER_IS_NOT_SET);
+    RETURN_CHECK_CODE_IF(graph_ == nullptr, WORKER_MANAGER_GRAPH_IS_NOT_SET);
+    RETURN_CHECK_CODE_IF(workers_.empty(), WORKER_MANAGER_HAS_NO_WORKER);
     for (const auto& w : workers_) {
-        std::string wmsg;
-        VALIDITY_CHECK_WITH_MSG(
-            !w.second.is_valid(&wmsg), valid, msg,
-            "Worker %d is invalid for the following reason(s):%s", w.first,
-            wmsg.c_str());
+        RETURN_IF_CHECK_FAILED(w.check());
+    }
+    return CheckCode::OK;
+}
+bool WorkerManager::is_valid(std::string* msg) const {
+    const bool valid = report_check(check(), msg);
+    if (!valid && msg) {
+        for (const auto& w : workers_) {
+            if (w.check() != CheckCode::OK) {
+                *msg += format_str("(worker %d)\n", w.id());
+                break;
+            }
+        }
     }
     return valid;
 }
 void WorkerManager::execute_job(discrete_time_t current_time, const Worker& w,
                                 job_id_t id, int amount) {
-    std::string validity_msg;
-    THROW_LOGIC_ERROR_IF(!is_valid(&validity_msg),
-                         "(before executing a job) WorkerManager is invalid "
-                         "for the following reason(s):%s",
-                         validity_msg.c_str());
+    THROW_INVARIANT_ERROR_IF(job_man_ == nullptr || sch_man_ == nullptr,
+                             "(before executing a job) WorkerManager is not "
+                             "connected to the other managers.");
     job_man_->execute_job(current_time, w, id, amount);
     sch_man_->accumulate_schedule_penalty(current_time, w.id(), id, amount);
     DEBUG("A job execution(worker_id:%d job_id:%d amount:%d) has finished.",
           w.id(), id, amount);
 }
 void WorkerManager::command_for_all_workers(discrete_time_t current_time,
-                                            std::istream& is) {
-    std::string validity_msg;
-    THROW_LOGIC_ERROR_IF(!is_valid(&validity_msg),
-                         "(before interpreting commands) WorkerManager is "
-                         "invalid for the following reason(s):%s",
-                         validity_msg.c_str());
-    for (auto& w : workers_) {
-        INFO("Enter an action for the worker(ID=%d):", w.first);
-        std::string line;
-        std::getline(is, line);
-        auto a = action::Action::interpret(line);
-        w.second.do_action(current_time, *a);
-        w.second.log_raw_action_string(line);
-        INFO("Action accepted:%s", stream_to_string(*a).c_str());
+                                            std::istream& is,
+                                            TurnProfiler* profiler) {
+    {
+        TurnPhaseTimer pt(profiler, TurnPhase::INPUT_VALIDATE);
+        std::string validity_msg;
+        THROW_INVARIANT_ERROR_IF(check() != CheckCode::OK &&
+                                     !is_valid(&validity_msg),
+                                 "(before interpreting commands) "
+                                 "WorkerManager is invalid for the following "
+                                 "reason(s):%s",
+                                 validity_msg.c_str());
+    }
+    std::string line;
+    for (const auto& w : workers_) {
+        INFO("Enter an action for the worker(ID=%d):", w.id());
+        int trailing_space_num = 0;
+        action::Action a;
+        {
+            TurnPhaseTimer pt(profiler, TurnPhase::INPUT_PARSE);
+            std::getline(is, line);
+            a = action::interpret(line, &trailing_space_num);
+        }
+        TurnPhaseTimer pt(profiler, TurnPhase::INPUT_APPLY);
+        command_worker(current_time, w.id(), a, trailing_space_num);
     }
+    TurnPhaseTimer pt(profiler, TurnPhase::INPUT_APPLY);
+    finish_commands(current_time);
+}
+void WorkerManager::command_worker(discrete_time_t current_time,
+                                   worker_id_t wid, const action::Action& a,
+                                   int trailing_space_num) {
+    THROW_LOGIC_ERROR_IF(!exists(wid), "worker id is out of range");
+    auto& w = workers_.at(wid);
+    w.do_action(current_time, a);
+    w.log_action(a, trailing_space_num);
+    INFO("Action accepted:%s", stream_to_string(a).c_str());
+}
+void WorkerManager::finish_commands(discrete_time_t current_time) {
     DEBUG("All the actions have been accepted.");
     job_man_->update_other_jobs(current_time);
     DEBUG("The other relevant jobs have been processed automatically.");
@@ -72,9 +111,10 @@ void WorkerManager::read_workers(std::istream& is) {
     int n;
     readline_exact(r, TAG(ValueGroup::POSITIVE_COUNT, n));
     THROW_RUNTIME_ERROR_IF(n <= 0, "Worker count must be positive.");
+    workers_.reserve(workers_.size() + n);
     for (int i = 0; i < n; i++) {
-        int id = id_gen_++;
-        auto& worker = workers_[id];
+        const worker_id_t id = workers_.size();
+        auto& worker = workers_.emplace_back();
         worker.id_ = id;
         worker.read_worker_info(is);
         worker.initialize();
@@ -83,18 +123,59 @@ void WorkerManager::read_workers(std::istream& is) {
     }
     DEBUG("Worker data loaded successfully.");
 }
-void WorkerManager::log_mutable_info_only(discrete_time_t crt0b, bool e) const {
-    this->LogInfoSwitcher::log_mutable_info_only(crt0b, e);
-    for_each_worker([&](worker_id_t id) {
-        for (auto& kv : workers_)
-            kv.second.log_mutable_info_only(crt0b, e);
-    });
+void WorkerManager::write_turn_log(BinaryLogWriter& w) const {
+    for (const auto& worker : workers_) {
+        worker.write_turn_log(w);
+    }
+}
+void WorkerManager::write_turn_log(JsonLogWriter& w) const {
+    w.begin_object();
+    w.key("workers");
+    w.begin_array();
+    for (const auto& worker : workers_) {
+        w.begin_array();
+        w.value(worker.id());
+        worker.write_turn_log(w);
+        w.end_array();
+    }
+    w.end_array();
+    w.end_object();
+}
+void WorkerManager::snapshot(SnapshotWriter& w) const {
+    w.write<uint64_t>(workers_.size());
+    for (const auto& worker : workers_) {
+        worker.snapshot(w);
+    }
+}
+void WorkerManager::replay_history(
+    discrete_time_t current_time,
+    const std::vector<action::ActionRecord>& actions) {
+    THROW_LOGIC_ERROR_IF(actions.size() != workers_.size(),
+                         "%d actions are given for %d workers",
+                         static_cast<int>(actions.size()), worker_num());
+    for (auto& worker : workers_) {
+        worker.replay_history(current_time, actions[worker.id()]);
+    }
+}
+discrete_time_t WorkerManager::history_length() const {
+    return workers_.empty() ? 0 : workers_.front().history_length();
+}
+void WorkerManager::restore(SnapshotReader& r) {
+    THROW_LOGIC_ERROR_IF(r.read<uint64_t>() != workers_.size(),
+                         "Worker num of the snapshot does not match.");
+    for (auto& worker : workers_) {
+        worker.restore(r);
+    }
 }
 bool WorkerManager::exists(worker_id_t wid) const {
-    return workers_.find(wid) != workers_.end();
+    return 0 <= wid && wid < worker_num();
 }
 void to_json(json_ref j, const WorkerManager& wm) {
+    json workers = json::array();
+    for (const auto& worker : wm.workers_) {
+        workers.push_back(json::array({worker.id(), worker}));
+    }
     j = json{
-        {"workers", wm.workers_},
+        {"workers", std::move(workers)},
     };
 }
@@ -1,33 +1,46 @@
 #ifndef HEADER_2HC2022_WORKER_MANAGER
 #define HEADER_2HC2022_WORKER_MANAGER 
-#include <atomic>
-#include <map>
 #include <string>
+#include <vector>
 #include "defines.hpp"
 #include "graph.hpp"
 #include "io.hpp"
 #include "job_manager.hpp"
 #include "json_fwd.hpp"
 #include "schedule_manager.hpp"
+#include "turn_profiler.hpp"
 #include "worker.hpp"
-class WorkerManager : public LogInfoSwitcher {
-    std::map<worker_id_t, Worker> workers_;
-    std::atomic<int> id_gen_{0};
+class WorkerManager {
+    std::vector<Worker> workers_;
     JobManager* job_man_ = nullptr;
     ScheduleManager* sch_man_ = nullptr;
     const UndirectedGraph* graph_ = nullptr;
  public:
-    void log_mutable_info_only(discrete_time_t crt0b, bool e) const override;
+    WorkerManager() = default;
+    WorkerManager(const WorkerManager& wm);
+    WorkerManager& operator=(const WorkerManager& wm) = delete;
     void command_for_all_workers(discrete_time_t current_time,
-                                 std::istream& is);
+                                 std::istream& is,
+                                 TurnProfiler* profiler = nullptr);
+    void command_worker(discrete_time_t current_time, worker_id_t wid,
+                        const action::Action& a, int trailing_space_num = 0);
+    void finish_commands(discrete_time_t current_time);
     void execute_job(discrete_time_t current_time, const Worker& w, job_id_t id,
                      int amount);
+    CheckCode check() const;
     bool is_valid(std::string* msg = nullptr) const;
     void set_schedule_manager(ScheduleManager* sm);
     void set_job_manager(JobManager* jm);
     void set_graph(const UndirectedGraph* gp);
     void read_workers(std::istream& is);
     int worker_num() const;
+    void snapshot(SnapshotWriter& w) const;
+    void write_turn_log(JsonLogWriter& w) const;
+    void write_turn_log(BinaryLogWriter& w) const;
+    void restore(SnapshotReader& r);
+    void replay_history(discrete_time_t current_time,
+                        const std::vector<action::ActionRecord>& actions);
+    discrete_time_t history_length() const;
     template <class Fn> void for_each_worker(const Fn& f) const {
         for (int i = 0; i < worker_num(); i++) {
             f(i);
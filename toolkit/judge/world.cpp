@@ -4,13 +4,18 @@
 #include <cinttypes>
 #include <cstring>
 #include <limits>
+#include <sstream>
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "binary_log.hpp"
 #include "error_check.hpp"
 #include "io.hpp"
+#include "json_log.hpp"
 #include "lib/json.hpp"
 #include "logger.hpp"
+#include "solver.hpp"
+#include "turn_profiler.hpp"
 void World::set_json_log_output_stream(std::ostream* optr) {
     json_log_ofs = optr;
 }
@@ -29,9 +34,19 @@ void World::begin_turn_json_log_output() const {
 }
 void World::output_turn_data_into_log(discrete_time_t t_0b) const {
     if (json_log_ofs) {
-        log_mutable_info_only(t_0b, true);
-        *json_log_ofs << json(*this);
-        log_mutable_info_only(t_0b, false);
+        JsonLogWriter w(*json_log_ofs);
+        w.begin_object();
+        w.key("job_manager");
+        job_manager.write_turn_log(w);
+        w.key("schedule_manager");
+        schedule_manager.write_turn_log(t_0b, w);
+        w.key("score_manager");
+        score_manager.write_turn_log(w);
+        w.key("weather_manager");
+        weather_manager.write_turn_log(w);
+        w.key("worker_manager");
+        worker_manager.write_turn_log(w);
+        w.end_object();
         if (t_0b < T_MAX() - 1) {
             *json_log_ofs << ",";
         }
@@ -49,34 +64,97 @@ void World::end_json_log_output(std::string final_score_str_,
         *json_log_ofs << "\"score\":" << final_score_str_
                       << ",\"unfinished_penalty\":" << unfinished_penalty_
                       << ",\"executed_jobs\":[";
-        if (job_manager.executed_jobs_.size() == 0) {
-        } else {
-            auto it = job_manager.executed_jobs_.begin();
-            *json_log_ofs << *it;
-            it++;
-            for (; it != job_manager.executed_jobs_.end(); it++) {
-                *json_log_ofs << "," << *it;
-            }
+        const char* sep = "";
+        job_manager.for_each_executed_job([&](job_id_t id) {
+            *json_log_ofs << sep << id;
+            sep = ",";
+        });
+        *json_log_ofs << "]";
+        if (profile_in_json_log_) {
+            *json_log_ofs << ",\"profile\":";
+            JsonLogWriter w(*json_log_ofs);
+            profiler_->write_json(w);
         }
-        *json_log_ofs << "]" << std::endl;
+        *json_log_ofs << std::endl;
         *json_log_ofs << "}";
         json_log_ofs->precision(log_prec_backup_);
     }
 }
+void World::set_binary_log_output_stream(std::ostream* optr) {
+    binary_log_ = optr ? std::make_shared<BinaryLogWriter>(*optr) : nullptr;
+}
+void World::set_seekable_log_output_stream(std::ostream* optr,
+                                           int keyframe_interval) {
+    seekable_log_ =
+        optr ? std::make_shared<SeekableLogWriter>(*optr, keyframe_interval)
+             : nullptr;
+}
+void World::set_turn_profiler(TurnProfiler* profiler, bool embed_in_json_log) {
+    profiler_ = profiler;
+    profile_in_json_log_ = profiler && embed_in_json_log;
+}
+void World::set_interaction_listener(InteractionListener* listener) {
+    interaction_listener_ = listener;
+}
+void World::set_distance_thread_num(unsigned thread_num) {
+    distance_thread_num_ = thread_num;
+}
+void World::begin_binary_log_output() {
+    if (binary_log_) {
+        binary_log_->begin_session(world_type(), T_MAX(), json(*this).dump());
+    }
+}
+void World::begin_turn_binary_log_output() {
+    if (binary_log_) {
+        job_manager.for_each_relevant_job(
+            [&](job_id_t id) { binary_log_->add_relevant_job(id); });
+        binary_log_->begin_turns(worker_manager.worker_num(),
+                                 weather_manager.weather_division_num());
+    }
+}
+void World::output_turn_data_into_binary_log(discrete_time_t t_0b) {
+    if (binary_log_) {
+        job_manager.write_turn_log(*binary_log_);
+        schedule_manager.write_turn_log(t_0b, *binary_log_);
+        score_manager.write_turn_log(*binary_log_);
+        weather_manager.write_turn_log(*binary_log_);
+        worker_manager.write_turn_log(*binary_log_);
+        binary_log_->end_turn();
+    }
+}
+void World::end_binary_log_output(final_result_t score,
+                                  double unfinished_penalty) {
+    if (binary_log_) {
+        std::vector<job_id_t> executed_jobs;
+        executed_jobs.reserve(job_manager.executed_job_num());
+        job_manager.for_each_executed_job(
+            [&](job_id_t id) { executed_jobs.push_back(id); });
+        binary_log_->end_session(score, unfinished_penalty, executed_jobs);
+    }
+}
 discrete_time_t World::T_MAX() const {
     return T_MAX_;
 }
 bool World::is_initialized() const {
     return initialized_;
 }
-void World::initialize() {
-    score_manager.initialize();
-    worker_manager.set_graph(&graph);
+const UndirectedGraph& World::graph() const {
+    return *graph_;
+}
+const TaskLimitInfo& World::task_limit_info() const {
+    return *task_limit_info_;
+}
+void World::connect_managers_() {
+    worker_manager.set_graph(graph_.get());
     worker_manager.set_job_manager(&job_manager);
     worker_manager.set_schedule_manager(&schedule_manager);
     job_manager.set_score_manager(&score_manager);
-    job_manager.set_task_limit_info(&task_limit_info);
+    job_manager.set_task_limit_info(task_limit_info_.get());
     job_manager.set_weather_manager(&weather_manager);
+}
+void World::initialize() {
+    score_manager.initialize();
+    connect_managers_();
     initialized_ = true;
 }
 bool World::is_loaded() const {
@@ -91,6 +169,7 @@ WorldType World::world_type() const {
 void World::read_from_stream(std::istream& is_raw) {
     THROW_LOGIC_ERROR_IF(!is_initialized(),
                          "Initialize world before read data from stream.");
+    THROW_LOGIC_ERROR_IF(is_loaded(), "World info is already loaded.");
     ValueReader is(is_raw);
     std::string wtstr;
     readline_exact(is, TAG(ValueGroup::STRING, wtstr));
@@ -101,12 +180,13 @@ void World::read_from_stream(std::istream& is_raw) {
     readline_exact(is,
                    TAG(ValueGroup::POSITIVE_COUNT, T_MAX_));
     THROW_RUNTIME_ERROR_IF(T_MAX_ < 1, "T_max has to be positive.");
-    graph.read_graph(is_raw);
-    graph.compute_distance_info();
+    graph_->read_graph(is_raw);
+    graph_->compute_distance_info(distance_thread_num_);
     worker_manager.read_workers(is_raw);
     job_manager.read_jobs(is_raw);
     weather_manager.read_from_stream(is_raw, T_MAX_);
-    task_limit_info.read_from_stream(is_raw);
+    task_limit_info_->read_from_stream(is_raw);
+    job_manager.build_task_limit_table();
     schedule_manager.read_from_stream(world_type(), is_raw);
     loaded_ = true;
 }
@@ -114,9 +194,9 @@ void World::output_graph_data_to_contestant(std::ostream& os) const {
     ValueWriter w(os);
     output_line_to_contestant(
         w,
-        TAG(ValueGroup::POSITIVE_COUNT, graph.vertex_num()),
-        TAG(ValueGroup::NON_NEGATIVE_COUNT, graph.edge_num()));
-    graph.for_each_edge(
+        TAG(ValueGroup::POSITIVE_COUNT, graph().vertex_num()),
+        TAG(ValueGroup::NON_NEGATIVE_COUNT, graph().edge_num()));
+    graph().for_each_edge(
         [&](vertex_index_t from, vertex_index_t to, distance_t d) {
             output_line_to_contestant_no_flush(
                 w,
@@ -157,19 +237,19 @@ void World::output_all_jobs_initial_data_to_contestant(std::ostream& os) const {
         output_line_to_contestant_no_flush(
             wr,
             TAG(ValueGroup::INDEX, job.id()),
-            TAG(ValueGroup::TYPEID, job.info.type),
-            TAG(ValueGroup::POSITIVE_COUNT, job.info.n_task),
-            TAG(ValueGroup::INDEX, job.info.position),
+            TAG(ValueGroup::TYPEID, job.info().type),
+            TAG(ValueGroup::POSITIVE_COUNT, job.info().n_task),
+            TAG(ValueGroup::INDEX, job.info().position),
             TAG(world_type() == WorldType::B ? ValueGroup::COEFFICIENT
                                              : ValueGroup::NONE,
-                job.info.penalty_coeff),
+                job.info().penalty_coeff),
             TAG(world_type() == WorldType::B ? ValueGroup::COEFFICIENT
                                              : ValueGroup::NONE,
-                job.info.weather_dependency),
+                job.info().weather_dependency),
             TAG(world_type() == WorldType::B ? ValueGroup::FLAG
                                              : ValueGroup::NONE,
-                job.info.mandatory));
-        using tv_pair = decltype(job.info.gain_function_data)::
+                job.info().mandatory));
+        using tv_pair = decltype(job.info().gain_function_data)::
             value_type;
         auto tv_pair_output = [](ValueWriter& wr_inner, const tv_pair& p) {
             concat_for_contestant(
@@ -180,13 +260,13 @@ void World::output_all_jobs_initial_data_to_contestant(std::ostream& os) const {
         output_line_to_contestant_no_flush(
             wr,
             TAG(ValueGroup::CONTAINER,
-                StreamAdapter(job.info.gain_function_data, tv_pair_output)));
+                StreamAdapter(job.info().gain_function_data, tv_pair_output)));
         auto depend_output = [](ValueWriter& wr_inner, const job_id_t id) {
             wr_inner << TAG(ValueGroup::INDEX, id);
         };
         output_line_to_contestant_no_flush(
             wr, TAG(ValueGroup::CONTAINER,
-                    StreamAdapter(job.info.dependency, depend_output)));
+                    StreamAdapter(job.info().dependency, depend_output)));
     });
     os.flush();
 }
@@ -200,12 +280,16 @@ void World::output_weather_initial_data_to_contestant(std::ostream& os) const {
             weather_manager.weather_value_num()));
     weather_manager
         .output_transition_matrix_to_contestant_WITH_TRAILING_NEWLINE(os);
-    task_limit_info.output_limit_constants_to_contestant(os);
+    task_limit_info().output_limit_constants_to_contestant(os);
 }
 void World::output_schedule_score_info_to_contestant(std::ostream& os) const {
     schedule_manager.output_to_contestant(os);
 }
 void World::update_turn(discrete_time_t t_0b) {
+    if (profiler_) {
+        profiler_->begin_turn(t_0b);
+    }
+    TurnPhaseTimer pt(profiler_, TurnPhase::UPDATE_TURN);
     if (t_0b > 0) {
         weather_manager.update(t_0b);
     }
@@ -223,7 +307,7 @@ void World::output_forecast_to_contestant_(std::ostream& os,
     for (int k = 0; k < rest_forecast_num; k++) {
         int forecast_time_0b = t_0b + k * weather_div_len;
 #ifndef ONLINE_JUDGE
-        const auto& probs = forecast[forecast_time_0b - t_0b];
+        const auto& probs = forecast[k];
         output_line_to_contestant_no_flush(
             wr, TAG(ValueGroup::TIME, forecast_time_0b),
             TAG(ValueGroup::CONTAINER,
@@ -235,7 +319,7 @@ void World::output_forecast_to_contestant_(std::ostream& os,
                     true)));
 #else
         os << to_1b(forecast_time_0b) << " "
-           << *(forecast_str[forecast_time_0b - t_0b]);
+           << *(forecast_str[k]);
 #endif
     }
 #ifdef ONLINE_JUDGE
@@ -284,55 +368,91 @@ void World::output_turn_data_to_contestant(discrete_time_t t_0b,
         }
     }
 }
+void World::check_schedule_change_num_(discrete_time_t t_0b,
+                                       int n_change) const {
+    THROW_WA_IF(WrongAnswerType::TOO_LARGE_WORKER_NUM_FOR_SCHEDULES,
+                n_change > worker_manager.worker_num(),
+                "too large worker num");
+    if (t_0b == 0) {
+        THROW_WA_IF(WrongAnswerType::FORCE_SCHEDULE_AT_TURN_1_NUM_WORKER,
+                    n_change != worker_manager.worker_num(),
+                    "Initial schedules must be submitted "
+                    "for all the workers.(Invalid number)");
+    }
+}
+void World::check_schedule_change_ids_(
+    discrete_time_t t_0b, const std::vector<worker_id_t>& change_ids) const {
+    auto sorted = change_ids;
+    std::sort(sorted.begin(), sorted.end());
+    THROW_WA_IF(WrongAnswerType::DUPS_IN_SCHEDULE_WORKERS,
+                std::adjacent_find(sorted.begin(), sorted.end()) !=
+                    sorted.end(),
+                "duplicate in schedule worker ids");
+    if (t_0b == 0) {
+        for (int i = 0; i < sorted.size(); i++) {
+            THROW_WA_IF(WrongAnswerType::FORCE_SCHEDULE_AT_TURN_1_ID_WORKER,
+                        sorted.at(i) != i,
+                        "Initial schedules must be submitted for all the "
+                        "workers.(Invalid id set)");
+        }
+    }
+}
+void World::read_turn_input_(std::istream& is, std::stringstream& buf) const {
+    buf.str("");
+    buf.clear();
+    std::string line;
+    int line_num = worker_manager.worker_num();
+    if (world_type() == WorldType::B && std::getline(is, line)) {
+        buf << line << '\n';
+        int n_change = 0;
+        std::istringstream(line) >> n_change;
+        line_num += 1 + std::clamp(n_change, 0, worker_manager.worker_num());
+    }
+    for (int i = 0; i < line_num && std::getline(is, line); i++) {
+        buf << line << '\n';
+    }
+}
 void World::input_turn_data_from_contestant(discrete_time_t t_0b,
                                             std::istream& is) {
     ValueReader r(is);
     if (world_type() == WorldType::B) {
         int n_change;
-        readline_exact(r,
-                       TAGWA(WrongAnswerType::NEGATIVE_WORKER_NUM_FOR_SCHEDULES,
-                             ValueGroup::NON_NEGATIVE_COUNT,
-                             n_change));
-        THROW_WA_IF(WrongAnswerType::TOO_LARGE_WORKER_NUM_FOR_SCHEDULES,
-                    n_change > worker_manager.worker_num(),
-                    "too large worker num");
-        if (t_0b == 0) {
-            THROW_WA_IF(WrongAnswerType::FORCE_SCHEDULE_AT_TURN_1_NUM_WORKER,
-                        n_change != worker_manager.worker_num(),
-                        "Initial schedules must be submitted "
-                        "for all the workers.(Invalid number)");
-        }
-        auto idssr = get_single_line_stream(r);
         std::vector<worker_id_t> change_ids;
-        read_n_vars_exact<worker_id_t>(
-            idssr, n_change, ValueGroup::INDEX,
-            [&](worker_id_t wid_0b) {
-                THROW_WA_IF(WrongAnswerType::WORKER_DOES_NOT_EXIST_FOR_SCHEDULE,
-                            !worker_manager.exists(wid_0b),
-                            "worker does not exist");
-                change_ids.push_back(wid_0b);
-            },
-            WrongAnswerType::N_CHANGE_NEQ_ACTUAL_WORKER_ID_NUM);
         {
-            auto sorted = change_ids;
-            std::sort(sorted.begin(), sorted.end());
-            THROW_WA_IF(WrongAnswerType::DUPS_IN_SCHEDULE_WORKERS,
-                        std::adjacent_find(sorted.begin(), sorted.end()) !=
-                            sorted.end(),
-                        "duplicate in schedule worker ids");
-            if (t_0b == 0) {
-                for (int i = 0; i < sorted.size(); i++) {
+            TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_PARSE);
+            readline_exact(
+                r, TAGWA(WrongAnswerType::NEGATIVE_WORKER_NUM_FOR_SCHEDULES,
+                         ValueGroup::NON_NEGATIVE_COUNT, n_change));
+        }
+        {
+            TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_VALIDATE);
+            check_schedule_change_num_(t_0b, n_change);
+        }
+        {
+            TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_PARSE);
+            auto idssr = get_single_line_stream(r);
+            read_n_vars_exact<worker_id_t>(
+                idssr, n_change, ValueGroup::INDEX,
+                [&](worker_id_t wid_0b) {
                     THROW_WA_IF(
-                        WrongAnswerType::FORCE_SCHEDULE_AT_TURN_1_ID_WORKER,
-                        sorted.at(i) != i,
-                        "Initial schedules must be submitted for all the "
-                        "workers.(Invalid id set)");
-                }
-            }
+                        WrongAnswerType::WORKER_DOES_NOT_EXIST_FOR_SCHEDULE,
+                        !worker_manager.exists(wid_0b),
+                        "worker does not exist");
+                    change_ids.push_back(wid_0b);
+                },
+                WrongAnswerType::N_CHANGE_NEQ_ACTUAL_WORKER_ID_NUM);
+        }
+        {
+            TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_VALIDATE);
+            check_schedule_change_ids_(t_0b, change_ids);
         }
         for (auto wid_0b : change_ids) {
             Schedule s;
-            s.read_from_stream(t_0b, T_MAX(), is);
+            {
+                TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_PARSE);
+                s.read_from_stream(t_0b, T_MAX(), is);
+            }
+            TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_APPLY);
             schedule_manager.set_new_schedule(t_0b, wid_0b,
                                               s);
         }
@@ -341,6 +461,80 @@ void World::input_turn_data_from_contestant(discrete_time_t t_0b,
                   schedule_manager.get_schedule_penalty(wid));
         });
     } else {
+        TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_APPLY);
+        submit_schedule_changes(t_0b, {});
+    }
+    worker_manager.command_for_all_workers(t_0b,
+                                           is, profiler_);
+}
+void World::begin_session() {
+    THROW_LOGIC_ERROR_IF(!is_loaded(), "Load world info before interaction");
+    begin_json_log_output();
+    begin_binary_log_output();
+}
+void World::accept_jobs(const std::vector<job_id_t>& ids) {
+    THROW_LOGIC_ERROR_IF(world_type() != WorldType::B,
+                         "Jobs are selected only in world type B");
+    job_manager.accept_jobs(ids);
+}
+void World::begin_turns() {
+    if (world_type() == WorldType::A) {
+        job_manager.accept_all_jobs();
+    } else if (world_type() != WorldType::B) {
+        THROW_LOGIC_ERROR_IF(true, "Invalid world type");
+    }
+    begin_turn_json_log_output();
+    begin_turn_binary_log_output();
+    if (seekable_log_) {
+        seekable_log_->begin_turns(*this);
+    }
+}
+void World::observe_turn(discrete_time_t t_0b, TurnObservation& obs) const {
+    obs.time = t_0b;
+    obs.weather = weather_manager.get_weather_value(t_0b);
+    obs.relevant_job_task_rest.clear();
+    job_manager.for_each_relevant_job([&](job_id_t rel_job_id) {
+        obs.relevant_job_task_rest.emplace_back(
+            rel_job_id, job_manager.jobs(rel_job_id).task_rest());
+    });
+    obs.newly_ready_jobs.clear();
+    job_manager.for_each_newly_ready_job(
+        [&](job_id_t id) { obs.newly_ready_jobs.push_back(id); });
+    obs.worker_positions.clear();
+    worker_manager.for_each_worker([&](worker_id_t id) {
+        obs.worker_positions.push_back(
+            worker_manager.workers(id).current_position());
+    });
+    obs.forecast_updated =
+        world_type() == WorldType::B &&
+        t_0b % weather_manager.weather_division_length() == 0;
+    if (obs.forecast_updated) {
+        obs.forecast = weather_manager.probability_forecast(t_0b);
+    }
+}
+void World::submit_schedule_changes(
+    discrete_time_t t_0b,
+    const std::vector<std::pair<worker_id_t, Schedule>>& changes) {
+    if (world_type() == WorldType::B) {
+        check_schedule_change_num_(t_0b, changes.size());
+        std::vector<worker_id_t> change_ids;
+        for (const auto& [wid_0b, s] : changes) {
+            THROW_WA_IF(WrongAnswerType::WORKER_DOES_NOT_EXIST_FOR_SCHEDULE,
+                        !worker_manager.exists(wid_0b),
+                        "worker does not exist");
+            change_ids.push_back(wid_0b);
+        }
+        check_schedule_change_ids_(t_0b, change_ids);
+        for (const auto& [wid_0b, s] : changes) {
+            THROW_LOGIC_ERROR_IF(s.update_time() != t_0b || s.T_max() != T_MAX(),
+                                 "Schedule for worker %d is not created "
+                                 "for this turn",
+                                 wid_0b);
+            schedule_manager.set_new_schedule(t_0b, wid_0b, s);
+        }
+    } else {
+        THROW_LOGIC_ERROR_IF(!changes.empty(),
+                             "Schedules are submitted only in world type B");
         if (t_0b == 0) {
             worker_manager.for_each_worker([&](worker_id_t wid) {
                 Schedule s;
@@ -349,13 +543,133 @@ void World::input_turn_data_from_contestant(discrete_time_t t_0b,
             });
         }
     }
-    worker_manager.command_for_all_workers(t_0b,
-                                           is);
+}
+void World::check_action_num_(size_t action_num) const {
+    THROW_WA_IF(WrongAnswerType::ACTION_NUM_NEQ_WORKER_NUM,
+                static_cast<worker_id_t>(action_num) !=
+                    worker_manager.worker_num(),
+                "%d actions are given for %d workers",
+                static_cast<worker_id_t>(action_num),
+                worker_manager.worker_num());
+}
+void World::submit_actions(discrete_time_t t_0b,
+                           const std::vector<action::Action>& actions) {
+    check_action_num_(actions.size());
+    worker_manager.for_each_worker([&](worker_id_t wid) {
+        worker_manager.command_worker(t_0b, wid, actions[wid]);
+    });
+    worker_manager.finish_commands(t_0b);
+}
+void World::submit_actions(discrete_time_t t_0b,
+                           const std::vector<action::ActionRecord>& actions) {
+    check_action_num_(actions.size());
+    worker_manager.for_each_worker([&](worker_id_t wid) {
+        worker_manager.command_worker(t_0b, wid, actions[wid].action,
+                                      actions[wid].trailing_space_num);
+    });
+    worker_manager.finish_commands(t_0b);
+}
+void World::end_turn(discrete_time_t t_0b) {
+    {
+        TurnPhaseTimer pt(profiler_, TurnPhase::FINALIZE_TASKS);
+        job_manager.finalize_task_done(
+            [&](job_id_t id) { score_manager.join_jobwise_score(id); });
+    }
+    INFO("Score(intermediate):%s", score_manager.score().str().c_str());
+    if (json_log_ofs) {
+        TurnPhaseTimer pt(profiler_, TurnPhase::JSON_LOG);
+        output_turn_data_into_log(t_0b);
+    }
+    if (binary_log_) {
+        TurnPhaseTimer pt(profiler_, TurnPhase::BINARY_LOG);
+        output_turn_data_into_binary_log(t_0b);
+    }
+    if (seekable_log_) {
+        TurnPhaseTimer pt(profiler_, TurnPhase::SEEKABLE_LOG);
+        seekable_log_->end_turn(*this, t_0b);
+    }
+}
+final_result_t World::end_session() {
+    end_turn_json_log_output();
+    int64_t score_integer = 0;
+    double unfinished_penalty = 1.0;
+    if (world_type() == WorldType::A) {
+        score_integer = score_manager.exact_score().floor();
+    } else if (world_type() == WorldType::B) {
+        double penalty_coeff = 1.0;
+        job_manager.for_each_accepted_job([&](job_id_t aid) {
+            const auto& job = job_manager.jobs(aid);
+            if (!job.completed()) {
+                INFO("Unfinished job:%d (Penalty:%.17g)", aid,
+                     job.info().penalty_coeff);
+                penalty_coeff *=
+                    job.info().penalty_coeff;
+            }
+        });
+        INFO("Total unfinished job penalty:%.17g", penalty_coeff);
+        unfinished_penalty = penalty_coeff;
+        penalty_coeff *= schedule_manager.calc_schedule_bonus_coefficient();
+        score_integer = score_manager.exact_score().floor_scaled(penalty_coeff);
+    } else {
+        THROW_LOGIC_ERROR_IF(true, "Unsupported world type");
+    }
+    end_json_log_output(std::to_string(score_integer), unfinished_penalty);
+    end_binary_log_output(score_integer, unfinished_penalty);
+    if (seekable_log_) {
+        seekable_log_->end_session();
+    }
+    INFO("Final score:%" PRId64, score_integer);
+    return score_integer;
+}
+world_snapshot_t World::snapshot() const {
+    world_snapshot_t blob;
+    snapshot(blob);
+    return blob;
+}
+void World::snapshot(world_snapshot_t& blob) const {
+    THROW_LOGIC_ERROR_IF(!job_manager.done_job_acceptance(),
+                         "Snapshots are available after job acceptance.");
+    blob.clear();
+    SnapshotWriter w(blob);
+    w.write(type_);
+    w.write(T_MAX_);
+    w.write(job_manager.relevant_job_num());
+    job_manager.snapshot(w);
+    score_manager.snapshot(w);
+    weather_manager.snapshot(w);
+    worker_manager.snapshot(w);
+    schedule_manager.snapshot(w);
+}
+void World::restore(const world_snapshot_t& blob) {
+    THROW_LOGIC_ERROR_IF(!job_manager.done_job_acceptance(),
+                         "Snapshots are available after job acceptance.");
+    SnapshotReader r(blob);
+    THROW_LOGIC_ERROR_IF(r.read<WorldType>() != type_ ||
+                             r.read<discrete_time_t>() != T_MAX_ ||
+                             r.read<int>() != job_manager.relevant_job_num(),
+                         "The snapshot was taken in another world.");
+    job_manager.restore(r);
+    score_manager.restore(r);
+    weather_manager.restore(r);
+    worker_manager.restore(r);
+    schedule_manager.restore(r);
+    THROW_RUNTIME_ERROR_IF(!r.at_end(), "The snapshot has trailing data.");
+}
+std::unique_ptr<World> World::fork() const {
+    THROW_LOGIC_ERROR_IF(!is_loaded(), "Load world info before forking.");
+    std::unique_ptr<World> w(new World(*this));
+    w->json_log_ofs = nullptr;
+    w->binary_log_ = nullptr;
+    w->seekable_log_ = nullptr;
+    w->profiler_ = nullptr;
+    w->profile_in_json_log_ = false;
+    w->interaction_listener_ = nullptr;
+    w->connect_managers_();
+    return w;
 }
 final_result_t World::interact(std::istream& is, std::ostream& os) {
-    THROW_LOGIC_ERROR_IF(!is_loaded(), "Load world info before interaction");
+    begin_session();
     auto os_prec_old = os.precision(std::numeric_limits<double>::max_digits10);
-    begin_json_log_output();
     ValueWriter wr(os);
     output_line_to_contestant(
         wr, TAG(ValueGroup::POSITIVE_COUNT, T_MAX()));
@@ -367,90 +681,81 @@ final_result_t World::interact(std::istream& is, std::ostream& os) {
         output_schedule_score_info_to_contestant(
             os);
         output_forecast_to_contestant_(os, 0);
-    }
-    if (world_type() == WorldType::B) {
         job_manager.accept_jobs(is);
-    } else if (world_type() == WorldType::A) {
-        job_manager.accept_all_jobs();
-    } else {
-        THROW_LOGIC_ERROR_IF(true, "Invalid world type");
     }
-    begin_turn_json_log_output();
+    begin_turns();
+    std::stringstream turn_input;
     for (discrete_time_t t_0b = 0; t_0b < T_MAX(); t_0b++) {
         update_turn(t_0b);
         if (world_type() == WorldType::B) {
+            TurnPhaseTimer pt(profiler_, TurnPhase::OUTPUT_TURN_DATA);
             output_turn_data_to_contestant(t_0b, os);
         }
-        input_turn_data_from_contestant(t_0b, is);
-        job_manager.for_each_relevant_job([&](job_id_t id) {
-            job_manager.jobs(id).finalize_task_done();
-            if (job_manager.jobs(id).completed()) {
-                score_manager.join_jobwise_score(id);
+        if (interaction_listener_) {
+            interaction_listener_->begin_turn_input(t_0b);
+        }
+        if (profiler_ || interaction_listener_) {
+            {
+                TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_READ);
+                read_turn_input_(is, turn_input);
             }
-        });
-        INFO("Score(intermediate):%s", score_manager.score().str().c_str());
-        output_turn_data_into_log(t_0b);
-    }
-    end_turn_json_log_output();
-    float_score_t score = 0;
-    double unfinished_penalty = 1.0;
-    if (world_type() == WorldType::A) {
-        score = score_manager.score();
-    } else if (world_type() == WorldType::B) {
-        double penalty_coeff = 1.0;
-        job_manager.for_each_accepted_job([&](job_id_t aid) {
-            const auto& job = job_manager.jobs(aid);
-            if (!job.completed()) {
-                INFO("Unfinished job:%d (Penalty:%.17g)", aid,
-                     job.info.penalty_coeff);
-                penalty_coeff *=
-                    job.info.penalty_coeff;
+            if (interaction_listener_) {
+                interaction_listener_->end_turn_input(t_0b);
             }
-        });
-        INFO("Total unfinished job penalty:%.17g", penalty_coeff);
-        unfinished_penalty = penalty_coeff;
-        penalty_coeff *= schedule_manager.calc_schedule_bonus_coefficient();
-        score = score_manager.score() * penalty_coeff;
-    } else {
-        THROW_LOGIC_ERROR_IF(true, "Unsupported world type");
+            input_turn_data_from_contestant(t_0b, turn_input);
+        } else {
+            input_turn_data_from_contestant(t_0b, is);
+        }
+        end_turn(t_0b);
     }
-    using std::floor;
-    int64_t score_integer = static_cast<int64_t>(floor(score));
+    int64_t score_integer = end_session();
     output_line_to_contestant(
         wr, TAG(ValueGroup::SCORE, score_integer));
-    end_json_log_output(std::to_string(score_integer), unfinished_penalty);
     os.precision(os_prec_old);
-    INFO("Final score:%" PRId64, score_integer);
     return score_integer;
 }
-void World::log_mutable_info_only(discrete_time_t crt0b, bool e) const {
-    this->LogInfoSwitcher::log_mutable_info_only(crt0b, e);
-    job_manager.log_mutable_info_only(crt0b, e);
-    weather_manager.log_mutable_info_only(crt0b, e);
-    worker_manager.log_mutable_info_only(crt0b, e);
-    schedule_manager.log_mutable_info_only(crt0b, e);
+final_result_t World::run(Solver& solver) {
+    begin_session();
+    solver.initialize(*this);
+    if (world_type() == WorldType::B) {
+        accept_jobs(solver.select_jobs(*this));
+    }
+    begin_turns();
+    TurnObservation obs;
+    TurnDecision decision;
+    for (discrete_time_t t_0b = 0; t_0b < T_MAX(); t_0b++) {
+        update_turn(t_0b);
+        {
+            TurnPhaseTimer pt(profiler_, TurnPhase::OUTPUT_TURN_DATA);
+            observe_turn(t_0b, obs);
+        }
+        decision.clear();
+        {
+            TurnPhaseTimer pt(profiler_, TurnPhase::SOLVER_DECIDE);
+            solver.decide(*this, obs, decision);
+        }
+        {
+            TurnPhaseTimer pt(profiler_, TurnPhase::INPUT_APPLY);
+            submit_schedule_changes(t_0b, decision.schedule_changes);
+            submit_actions(t_0b, decision.actions);
+        }
+        end_turn(t_0b);
+    }
+    final_result_t score_integer = end_session();
+    solver.finalize(*this, score_integer);
+    return score_integer;
 }
 void to_json(json_ref j, const World& w) {
-    if (w.log_mutable_only_) {
-        j = json{
-            {"job_manager", w.job_manager},
-            {"score_manager", w.score_manager},
-            {"weather_manager", w.weather_manager},
-            {"worker_manager", w.worker_manager},
-            {"schedule_manager", w.schedule_manager},
-        };
-    } else {
-        j = json{
-            {"T_max", w.T_MAX_},
-            {"initialized", w.initialized_},
-            {"loaded", w.loaded_},
-            {"graph", w.graph},
-            {"job_manager", w.job_manager},
-            {"score_manager", w.score_manager},
-            {"task_limit_info", w.task_limit_info},
-            {"weather_manager", w.weather_manager},
-            {"worker_manager", w.worker_manager},
-            {"schedule_manager", w.schedule_manager}
-        };
-    }
+    j = json{
+        {"T_max", w.T_MAX_},
+        {"initialized", w.initialized_},
+        {"loaded", w.loaded_},
+        {"graph", w.graph()},
+        {"job_manager", w.job_manager},
+        {"score_manager", w.score_manager},
+        {"task_limit_info", w.task_limit_info()},
+        {"weather_manager", w.weather_manager},
+        {"worker_manager", w.worker_manager},
+        {"schedule_manager", w.schedule_manager}
+    };
 }
@@ -1,14 +1,32 @@
 #ifndef HEADER_2HC2022_WORLD
 #define HEADER_2HC2022_WORLD 
+#include <memory>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 #include "defines.hpp"
 #include "graph.hpp"
 #include "io.hpp"
 #include "job_manager.hpp"
 #include "json_fwd.hpp"
 #include "schedule_manager.hpp"
+#include "seekable_log.hpp"
+#include "snapshot.hpp"
+#include "turn_profiler.hpp"
 #include "worker_manager.hpp"
-class World : public LogInfoSwitcher {
+class BinaryLogWriter;
+class SeekableLogWriter;
+class Solver;
+struct TurnObservation;
+struct TurnDecision;
+class InteractionListener {
+ public:
+    virtual ~InteractionListener() = default;
+    virtual void begin_turn_input(discrete_time_t t_0b) = 0;
+    virtual void end_turn_input(discrete_time_t t_0b) = 0;
+};
+class World {
     discrete_time_t T_MAX_ = INVALID_TIME;
     bool initialized_ = false;
     bool loaded_ = false;
@@ -20,18 +38,50 @@ class World : public LogInfoSwitcher {
     void end_turn_json_log_output() const;
     void end_json_log_output(std::string final_score_str_,
                              double unfinished_penalty_) const;
+    std::shared_ptr<BinaryLogWriter> binary_log_;
+    void begin_binary_log_output();
+    void begin_turn_binary_log_output();
+    void output_turn_data_into_binary_log(discrete_time_t t_0b);
+    void end_binary_log_output(final_result_t score,
+                               double unfinished_penalty);
+    std::shared_ptr<SeekableLogWriter> seekable_log_;
+    TurnProfiler* profiler_ = nullptr;
+    bool profile_in_json_log_ = false;
+    InteractionListener* interaction_listener_ = nullptr;
+    unsigned distance_thread_num_ = 0;
+    void read_turn_input_(std::istream& is, std::stringstream& buf) const;
     WorldType type_ = WorldType::A;
     void set_world_type(WorldType ty_);
     void output_forecast_to_contestant_(std::ostream& os,
                                         discrete_time_t t_0b) const;
+    void check_schedule_change_num_(discrete_time_t t_0b, int n_change) const;
+    void check_action_num_(size_t action_num) const;
+    void check_schedule_change_ids_(
+        discrete_time_t t_0b, const std::vector<worker_id_t>& change_ids) const;
+    std::shared_ptr<UndirectedGraph> graph_ =
+        std::make_shared<UndirectedGraph>();
+    std::shared_ptr<TaskLimitInfo> task_limit_info_ =
+        std::make_shared<TaskLimitInfo>();
+    void connect_managers_();
+    World(const World& w) = default;
  public:
-    void log_mutable_info_only(discrete_time_t crt0b, bool e) const override;
+    World() = default;
+    World& operator=(const World& w) = delete;
     void set_json_log_output_stream(std::ostream* optr);
+    void set_binary_log_output_stream(std::ostream* optr);
+    void set_seekable_log_output_stream(
+        std::ostream* optr, int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL);
+    void set_turn_profiler(TurnProfiler* profiler,
+                           bool embed_in_json_log = false);
+    void set_interaction_listener(InteractionListener* listener);
+    // Threads used for the all-pairs distances on load (0: all hardware
+    // threads).
+    void set_distance_thread_num(unsigned thread_num);
     discrete_time_t T_MAX() const;
-    UndirectedGraph graph;
+    const UndirectedGraph& graph() const;
     JobManager job_manager;
     ScoreManager score_manager;
-    TaskLimitInfo task_limit_info;
+    const TaskLimitInfo& task_limit_info() const;
     WeatherManager weather_manager;
     WorkerManager worker_manager;
     ScheduleManager schedule_manager;
@@ -40,6 +90,24 @@ class World : public LogInfoSwitcher {
     bool is_loaded() const;
     void read_from_stream(std::istream& is);
     final_result_t interact(std::istream& is, std::ostream& os);
+    final_result_t run(Solver& solver);
+    void begin_session();
+    void accept_jobs(const std::vector<job_id_t>& ids);
+    void begin_turns();
+    void observe_turn(discrete_time_t t_0b, TurnObservation& obs) const;
+    void submit_schedule_changes(
+        discrete_time_t t_0b,
+        const std::vector<std::pair<worker_id_t, Schedule>>& changes);
+    void submit_actions(discrete_time_t t_0b,
+                        const std::vector<action::Action>& actions);
+    void submit_actions(discrete_time_t t_0b,
+                        const std::vector<action::ActionRecord>& actions);
+    void end_turn(discrete_time_t t_0b);
+    final_result_t end_session();
+    world_snapshot_t snapshot() const;
+    void snapshot(world_snapshot_t& blob) const;
+    void restore(const world_snapshot_t& blob);
+    std::unique_ptr<World> fork() const;
     void output_graph_data_to_contestant(std::ostream& os) const;
     void output_worker_initial_data_to_contestant(std::ostream& os) const;
     void output_all_jobs_initial_data_to_contestant(std::ostream& os) const;